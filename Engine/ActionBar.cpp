@@ -2,21 +2,26 @@
 #include "SpriteEffect.h"
 #include "RectF.h"
 
-ActionBar::ActionBar()
+ActionBar::ActionBar( AssetManager& assets )
     :
-    m_factoryImg( "..\\images\\actionBar\\factory.bmp" ),
-    m_barracksImg( "..\\images\\actionBar\\barracks.bmp" ),
 #if _DEBUG
-    m_img( "..\\images\\debugImg.bmp" )
+    m_img( assets.getSurface( "..\\images\\debugImg.bmp" ) ),
 #else
-    m_img( "..\\images\\actionBar\\actionBar.bmp" )
+    m_img( assets.getSurface( "..\\images\\actionBar\\actionBar.bmp" ) ),
 #endif
-{
+    m_factoryImg( assets.getSprite( "..\\images\\actionBar\\factory.bmp" ) ),
+    m_barracksImg( assets.getSprite( "..\\images\\actionBar\\barracks.bmp" ) ),
+    m_factoryRle( m_factoryImg.makeRle( { 255, 242, 0 } ) ),
+    m_barracksRle( m_barracksImg.makeRle( { 255, 242, 0 } ) ),
+    m_factoryGhost( m_factoryImg.pPage->Premultiplied( m_factoryImg.rect, { 255, 242, 0 }, 128 ) ),
+    m_barracksGhost( m_barracksImg.pPage->Premultiplied( m_barracksImg.rect, { 255, 242, 0 }, 128 ) ),
 #if _DEBUG
-    m_width = 200;
+    m_width( 200 ),
 #else
-    m_width = m_img.GetWidth();
+    m_width( m_img.GetWidth() ),
 #endif
+    m_barImg( m_width, Graphics::ScreenHeight )
+{
     const int size      = m_width / 2;
     const int startY    = 50;
     /* barracks (top left) */
@@ -26,56 +31,66 @@ ActionBar::ActionBar()
     m_vRectsInBar_buildings.push_back( RectI( Graphics::ScreenWidth - size, Graphics::ScreenWidth, startY, startY + size ) );
 }
 
-void ActionBar::draw( Graphics& gfx, Font& font, const Vec2& mousePos )
+namespace
 {
-    RectI r( Graphics::ScreenWidth - m_width, Graphics::ScreenWidth, 0, Graphics::ScreenHeight );
-    gfx.DrawRect( r, Colors::LightGray );
-    //gfx.DrawSprite( Graphics::ScreenWidth - m_width, 0, m_img, SpriteEffect::Copy{} );
-
-    /* draw building rects */
-    for( auto b : m_vRectsInBar_buildings )
+    /* copies all pixels of src except the chroma coloured ones, clipped to dst */
+    void copyKeyed( Surface& dst, const int x, const int y, const SpriteAtlas::Region& src, const Color chroma )
     {
-        gfx.DrawRectBorder( b, 2, Colors::Blue );
+        for( int sy = std::max( 0, -y ); sy < std::min( src.getHeight(), dst.GetHeight() - y ); ++sy )
+        {
+            const Color* pSrc = src.pPage->GetRow( src.rect.top + sy ) + src.rect.left;
+            for( int sx = std::max( 0, -x ); sx < std::min( src.getWidth(), dst.GetWidth() - x ); ++sx )
+            {
+                if( pSrc[ sx ] != chroma )
+                {
+                    dst.PutPixel( x + sx, y + sy, pSrc[ sx ] );
+                }
+            }
+        }
     }
+    void drawBorder( Surface& dst, const RectI& r, const int border, const Color c )
+    {
+        dst.Fill( RectI( r.left, r.right, r.top, r.top + border ), c );
+        dst.Fill( RectI( r.left, r.right, r.bottom - border, r.bottom ), c );
+        dst.Fill( RectI( r.left, r.left + border, r.top, r.bottom ), c );
+        dst.Fill( RectI( r.right - border, r.right, r.top, r.bottom ), c );
+    }
+}
 
-    /* draw building names/images */
-    gfx.DrawSprite( m_vRectsInBar_buildings[ ( int )Building::Type::BARRACKS ].left + 10, m_vRectsInBar_buildings[ ( int )Building::Type::BARRACKS ].top + 10,
-                    m_barracksImg, SpriteEffect::Chroma( { 255, 242, 0 } ) );
-    gfx.DrawSprite( m_vRectsInBar_buildings[ ( int )Building::Type::FACTORY ].left, m_vRectsInBar_buildings[ ( int )Building::Type::BARRACKS ].top + 10,
-                    m_factoryImg, SpriteEffect::Chroma( { 255, 242, 0 } ) );
-    font.DrawText( "B", m_vRectsInBar_buildings[ ( int )Building::Type::BARRACKS ].GetCenter() - Vei2( m_width / 5, m_width / 5 ), Colors::Blue, gfx );
-    font.DrawText( "F", m_vRectsInBar_buildings[ ( int )Building::Type::FACTORY ].GetCenter() - Vei2( m_width / 5, m_width / 5 ), Colors::Blue, gfx );
-
-    /* dummy text */
-    font.DrawText( "resources", Vei2( Graphics::ScreenWidth - m_width + 2, 10 ), Colors::Blue, gfx );
-    font.DrawText( "other", Vei2( Graphics::ScreenWidth - m_width + 2, 180 ), Colors::Blue, gfx );
-    font.DrawText( "buildings", Vei2( Graphics::ScreenWidth - m_width + 2, 210 ), Colors::Blue, gfx );
-    font.DrawText( "units", Vei2( Graphics::ScreenWidth - m_width + 2, 280 ), Colors::Blue, gfx );
-
-    /* minimap dummy */
-    RectI minimapRect( Graphics::ScreenWidth - m_width, Graphics::ScreenWidth, Graphics::ScreenHeight - 150, Graphics::ScreenHeight );
-    gfx.DrawRectBorder( minimapRect, 4, Colors::Yellow );
-    font.DrawText( "Minimap", minimapRect.GetCenter() - Vei2( m_width / 3, 10 ), Colors::Blue, gfx );
+void ActionBar::draw( Graphics& gfx, Font& font, const Vec2& mousePos )
+{
+    const int hoveredButton = getButtonAt( mousePos );
+    const int placingButton = m_bPlacing ? ( int )m_buildingType : -1;
+    if( !m_bBarComposed || hoveredButton != m_hoveredButton || placingButton != m_placingButton )
+    {
+        m_hoveredButton = hoveredButton;
+        m_placingButton = placingButton;
+        composeBar( font );
+    }
+    gfx.DrawOpaque( Graphics::ScreenWidth - m_width, 0, m_barImg.GetRect(), m_barImg, m_barVersion );
 
     /* building placing */
     if( m_bPlacing )
     {
-        Surface* pCurrentBuilding = nullptr;
+        const Surface* pCurrentGhost = nullptr;
+        RleSprite* pCurrentBuildingRle = nullptr;
         switch( m_buildingType )
         {
         case Building::Type::BARRACKS:
-            pCurrentBuilding = &m_barracksImg;
+            pCurrentGhost = &m_barracksGhost;
+            pCurrentBuildingRle = &m_barracksRle;
             break;
         case Building::Type::FACTORY:
-            pCurrentBuilding = &m_factoryImg;
+            pCurrentGhost = &m_factoryGhost;
+            pCurrentBuildingRle = &m_factoryRle;
             break;
         default:
-            pCurrentBuilding = nullptr;
+            pCurrentGhost = nullptr;
         }
 
         if( mousePos.x >= Graphics::ScreenWidth - m_width )
         {
-            gfx.DrawSprite( ( int )mousePos.x, ( int )mousePos.y, *pCurrentBuilding, SpriteEffect::Ghost( { 255, 242, 0 } ) );
+            gfx.DrawSprite( ( int )mousePos.x, ( int )mousePos.y, *pCurrentGhost, SpriteEffect::AlphaBlend() );
         }
         else
         {
@@ -92,16 +107,65 @@ void ActionBar::draw( Graphics& gfx, Font& font, const Vec2& mousePos )
             }
             if( m_bFreeSpace )
             {
-                gfx.DrawSprite( ( int )m_vBuildingTiles.front().left, ( int )m_vBuildingTiles.front().top, *pCurrentBuilding, SpriteEffect::Chroma( { 255, 242, 0 } ) );
+                gfx.DrawSprite( ( int )m_vBuildingTiles.front().left, ( int )m_vBuildingTiles.front().top, *pCurrentBuildingRle );
             }
             else
             {
-                gfx.DrawSprite( ( int )m_vBuildingTiles.front().left, ( int )m_vBuildingTiles.front().top, *pCurrentBuilding, SpriteEffect::Ghost( { 255, 242, 0 } ) );
+                gfx.DrawSprite( ( int )m_vBuildingTiles.front().left, ( int )m_vBuildingTiles.front().top, *pCurrentGhost, SpriteEffect::AlphaBlend() );
             }
         }        
     }
 }
 
+void ActionBar::composeBar( const Font& font )
+{
+    /* screen coordinates -> bar image coordinates */
+    const Vei2 offset( Graphics::ScreenWidth - m_width, 0 );
+    m_barImg.Fill( m_barImg.GetRect(), Colors::LightGray );
+
+    /* building rects: placing one -> green, mouse over -> white */
+    for( int i = 0; i < m_vRectsInBar_buildings.size(); ++i )
+    {
+        const RectI& b = m_vRectsInBar_buildings[ i ];
+        const Color c = i == m_placingButton ? Colors::Green : ( i == m_hoveredButton ? Colors::White : Colors::Blue );
+        drawBorder( m_barImg, RectI( b.left - offset.x, b.right - offset.x, b.top, b.bottom ), 2, c );
+    }
+
+    /* building names/images */
+    const RectI& barracks = m_vRectsInBar_buildings[ ( int )Building::Type::BARRACKS ];
+    const RectI& factory = m_vRectsInBar_buildings[ ( int )Building::Type::FACTORY ];
+    copyKeyed( m_barImg, barracks.left + 10 - offset.x, barracks.top + 10, m_barracksImg, { 255, 242, 0 } );
+    copyKeyed( m_barImg, factory.left - offset.x, barracks.top + 10, m_factoryImg, { 255, 242, 0 } );
+    font.DrawText( "B", barracks.GetCenter() - Vei2( m_width / 5, m_width / 5 ) - offset, Colors::Blue, m_barImg );
+    font.DrawText( "F", factory.GetCenter() - Vei2( m_width / 5, m_width / 5 ) - offset, Colors::Blue, m_barImg );
+
+    /* dummy text */
+    font.DrawText( "resources", Vei2( 2, 10 ), Colors::Blue, m_barImg );
+    font.DrawText( "other", Vei2( 2, 180 ), Colors::Blue, m_barImg );
+    font.DrawText( "buildings", Vei2( 2, 210 ), Colors::Blue, m_barImg );
+    font.DrawText( "units", Vei2( 2, 280 ), Colors::Blue, m_barImg );
+
+    /* minimap frame, the map itself is drawn on top by the Minimap */
+    const RectI minimapRect = getMinimapRect().GetExpanded( minimapBorder );
+    drawBorder( m_barImg, RectI( minimapRect.left - offset.x, minimapRect.right - offset.x, minimapRect.top, minimapRect.bottom ), minimapBorder, Colors::Yellow );
+
+    m_bBarComposed = true;
+    m_barVersion++;
+}
+
+int ActionBar::getButtonAt( const Vec2& mousePos ) const
+{
+    for( int i = 0; i < m_vRectsInBar_buildings.size(); ++i )
+    {
+        RectI r = m_vRectsInBar_buildings[ i ];
+        if( r.Contains( mousePos ) )
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
 void ActionBar::update( const float dt, const Vec2& mousePos, const Vei2& camPos, const Level& level )
 {
     if( m_bPlacing )
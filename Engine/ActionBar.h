@@ -2,16 +2,18 @@
 #include <vector>
 #include "Graphics.h"
 #include "Surface.h"
+#include "RleSprite.h"
 #include "Mouse.h"
 #include "Building.h"
 #include "RectI.h"
 #include "Font.h"
 #include "Level.h"
+#include "AssetManager.h"
 
 class ActionBar
 {
 public:
-    ActionBar();
+    ActionBar( AssetManager& assets );
 
     void draw( Graphics& gfx, Font& font, const Vec2& mousePos );
 
@@ -32,13 +34,32 @@ public:
     {
         return m_bPlacing;
     }
+    RectI getMinimapRect() const            /* screen area of the minimap (inside of its frame) */
+    {
+        return RectI( Graphics::ScreenWidth - m_width + minimapBorder, Graphics::ScreenWidth - minimapBorder,
+                      Graphics::ScreenHeight - 150 + minimapBorder, Graphics::ScreenHeight - minimapBorder );
+    }
 private:
-    /* images and width of the action bar */
-    Surface m_img;
-    Surface m_factoryImg;
-    Surface m_barracksImg;
+    /* images (shared, owned by the AssetManager, the buildings are part of its sprite atlas) and width of the action bar */
+    const Surface& m_img;
+    SpriteAtlas::Region m_factoryImg;
+    SpriteAtlas::Region m_barracksImg;
+    RleSprite m_factoryRle;                 /* opaque parts of the building images */
+    RleSprite m_barracksRle;
+    Surface m_factoryGhost;                 /* half transparent (premultiplied alpha), blocked or outside of the level */
+    Surface m_barracksGhost;
     int m_width;
 
+    /* static part of the bar (background, buttons, labels), composed again only when the buttons change their look */
+    void composeBar( const Font& font );
+    int getButtonAt( const Vec2& mousePos ) const;      /* building button under the mouse, -1 if none */
+    Surface m_barImg;
+    bool m_bBarComposed = false;
+    unsigned int m_barVersion = 0;          /* changes with every composeBar() */
+    static constexpr int minimapBorder = 4;
+    int m_hoveredButton = -1;
+    int m_placingButton = -1;
+
     /* current building attributes */
     Building::Type m_buildingType;
     Vei2 m_buildingSize;
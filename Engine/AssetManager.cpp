@@ -0,0 +1,74 @@
+#include "AssetManager.h"
+#include <fstream>
+
+namespace
+{
+    /* FNV-1a (64 bit) of the file bytes as the version of an image, 0 if it cannot be opened. The size alone is no
+       version, a repainted bitmap of the same dimensions has the same size */
+    unsigned long long fileStamp( const std::string& filename )
+    {
+        std::ifstream file( filename, std::ios::binary );
+        if( !file )
+        {
+            return 0ull;
+        }
+        unsigned long long h = 14695981039346656037ull;
+        std::vector< char > buffer( 64 * 1024 );
+        while( file.read( buffer.data(), buffer.size() ) || file.gcount() > 0 )
+        {
+            const std::streamsize n = file.gcount();
+            for( std::streamsize i = 0; i < n; ++i )
+            {
+                h ^= ( unsigned char )buffer[ i ];
+                h *= 1099511628211ull;
+            }
+        }
+        return h;
+    }
+}
+
+AssetManager::AssetManager( const std::vector< std::string >& vAtlasImages, const std::string& atlasCacheFile )
+{
+    std::vector< unsigned long long > vStamps;
+    for( const auto& filename : vAtlasImages )
+    {
+        vStamps.push_back( fileStamp( filename ) );
+    }
+
+    m_bAtlasCached = m_atlas.load( atlasCacheFile, vAtlasImages, vStamps );
+    if( m_bAtlasCached )
+    {
+        m_nFilesRead += m_atlas.getNumPages();
+        return;
+    }
+    for( size_t i = 0; i < vAtlasImages.size(); ++i )
+    {
+        m_atlas.add( vAtlasImages[ i ], Surface( vAtlasImages[ i ] ), vStamps[ i ] );
+        m_nFilesRead++;
+    }
+    m_atlas.build();
+    m_atlas.save( atlasCacheFile );     /* no cache next time if this fails, nothing else depends on it */
+}
+
+const Surface& AssetManager::getSurface( const std::string& filename )
+{
+    m_nRequests++;
+    auto it = m_surfaces.find( filename );
+    if( it == m_surfaces.end() )
+    {
+        /* loaded straight into the map, the surface is moved and never copied */
+        it = m_surfaces.emplace( filename, Surface( filename ) ).first;
+        m_memoryUsage += sizeof( Color ) * it->second.GetWidth() * it->second.GetHeight();
+        m_nFilesRead++;
+    }
+    return it->second;
+}
+
+SpriteAtlas::Region AssetManager::getSprite( const std::string& filename )
+{
+    if( m_atlas.contains( filename ) )
+    {
+        return m_atlas.get( filename );
+    }
+    return SpriteAtlas::Region( getSurface( filename ) );
+}
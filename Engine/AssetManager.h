@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Surface.h"
+#include "SpriteAtlas.h"
+
+/* loads every image file only once, all users share the same immutable surface. The returned references stay valid as
+   long as the manager lives (the map nodes never move). Files are identified by the path as it is passed in */
+class AssetManager
+{
+public:
+    AssetManager() = default;
+    /* vAtlasImages are packed into a sprite atlas (getSprite()). The packed pages are cached in atlasCacheFile and
+       loaded from there as long as none of the images changed (hash of the file), otherwise packed again and saved */
+    AssetManager( const std::vector< std::string >& vAtlasImages, const std::string& atlasCacheFile );
+    AssetManager( const AssetManager& ) = delete;
+    AssetManager& operator=( const AssetManager& ) = delete;
+
+    const Surface& getSurface( const std::string& filename );
+    /* region inside of the atlas, images which are not part of it are loaded with getSurface() */
+    SpriteAtlas::Region getSprite( const std::string& filename );
+
+    int getNumFiles() const
+    {
+        return ( int )m_surfaces.size();
+    }
+    int getNumFilesRead() const                 /* image files loaded from disk (single images and atlas pages) */
+    {
+        return m_nFilesRead;
+    }
+    int getNumRequests() const                  /* all getSurface() calls, the ones above getNumFiles() were shared */
+    {
+        return m_nRequests;
+    }
+    size_t getMemoryUsage() const               /* pixel bytes of all loaded surfaces and atlas pages */
+    {
+        return m_memoryUsage + m_atlas.getMemoryUsage();
+    }
+    const SpriteAtlas& getAtlas() const
+    {
+        return m_atlas;
+    }
+    bool isAtlasCached() const                  /* atlas loaded from the cache file instead of packed */
+    {
+        return m_bAtlasCached;
+    }
+private:
+    std::unordered_map< std::string, Surface > m_surfaces;
+    SpriteAtlas m_atlas;
+    bool m_bAtlasCached = false;
+    int m_nFilesRead = 0;
+    int m_nRequests = 0;
+    size_t m_memoryUsage = 0;
+};
@@ -0,0 +1,381 @@
+#include "BandRenderer.h"
+#include <cassert>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+    struct DrawKeyHash
+    {
+        size_t operator()( const DrawKey& key ) const
+        {
+            return key.hash();
+        }
+    };
+
+    RectI intersect( const RectI& a, const RectI& b )
+    {
+        return RectI( std::max( a.left, b.left ), std::min( a.right, b.right ), std::max( a.top, b.top ), std::min( a.bottom, b.bottom ) );
+    }
+    bool isEmpty( const RectI& r )
+    {
+        return r.left >= r.right || r.top >= r.bottom;
+    }
+    RectI shift( const RectI& r, const Vei2& delta )
+    {
+        return RectI( r.left + delta.x, r.right + delta.x, r.top + delta.y, r.bottom + delta.y );
+    }
+}
+
+BandRenderer::BandRenderer( Graphics& gfx, const int nThreads )
+    :
+    m_gfx( gfx )
+{
+    setNumThreads( nThreads );
+}
+
+BandRenderer::~BandRenderer()
+{
+    stopWorkers();
+}
+
+void BandRenderer::setNumThreads( const int nThreads )
+{
+    assert( nThreads >= 1 && nThreads <= Graphics::ScreenHeight );
+    stopWorkers();
+    m_nThreads = nThreads;
+    startWorkers();
+}
+
+void BandRenderer::setDirtyTracking( const bool bEnable )
+{
+    m_bDirtyTracking = bEnable;
+    m_bInvalid = true;
+}
+
+void BandRenderer::setCamera( const Vei2& camOffset )
+{
+    /* a single scroll step still reuses the shifted frame buffer (findDirtyRects()) */
+    m_nScrollFrames = camOffset.x == m_camera.x && camOffset.y == m_camera.y ? 0 : m_nScrollFrames + 1;
+    m_camera = camOffset;
+    if( m_bDirtyTracking && isScrolling() )
+    {
+        m_bInvalid = true;      /* commands are not compared meanwhile, the first frame after scrolling is drawn completely */
+        m_dirtyFraction = 1.0f;
+    }
+}
+
+void BandRenderer::beginWorld( const Vei2& camOffset )
+{
+    assert( !m_bInWorld );
+    m_bInWorld = true;
+    m_worldOffset = camOffset;
+}
+
+void BandRenderer::endWorld()
+{
+    m_bInWorld = false;
+}
+
+void BandRenderer::record( DrawKey key, const RectI& bounds, std::function< void( Graphics& ) > command )
+{
+    /* world commands are compared in world space, so they still match after the camera moved */
+    if( m_bInWorld )
+    {
+        key.bWorld = true;
+        key.x += m_worldOffset.x;
+        key.y += m_worldOffset.y;
+    }
+    m_vCommands.push_back( { key, bounds, std::move( command ) } );
+}
+
+void BandRenderer::startWorkers()
+{
+    m_bQuit = false;
+    for( int band = 1; band < m_nThreads; ++band )
+    {
+        m_vWorkers.emplace_back( &BandRenderer::workerLoop, this, band, m_frame );
+    }
+}
+
+void BandRenderer::stopWorkers()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_bQuit = true;
+    }
+    m_cvStart.notify_all();
+    for( auto& w : m_vWorkers )
+    {
+        w.join();
+    }
+    m_vWorkers.clear();
+}
+
+void BandRenderer::render()
+{
+    if( m_bDirtyTracking )
+    {
+        findDirtyRects();
+    }
+    else
+    {
+        m_vDirtyRects.assign( 1, Graphics::GetScreenRect() );
+        m_dirtyFraction = 1.0f;
+    }
+
+    if( m_vDirtyRects.empty() )
+    {
+        /* nothing changed */
+    }
+    else if( m_nThreads > 1 )
+    {
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            m_nBusyWorkers = m_nThreads - 1;
+            m_frame++;
+        }
+        m_cvStart.notify_all();
+
+        renderBand( 0 );
+
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_cvDone.wait( lock, [ this ] { return m_nBusyWorkers == 0; } );
+    }
+    else
+    {
+        renderBand( 0 );
+    }
+
+    m_commandsLastFrame = ( int )m_vCommands.size();
+    m_vPrevCommands.swap( m_vCommands );
+    m_vCommands.clear();
+    m_prevWorldOffset = m_worldOffset;
+    m_bInvalid = false;
+}
+
+void BandRenderer::workerLoop( const int band, unsigned int lastFrame )
+{
+    while( true )
+    {
+        {
+            std::unique_lock< std::mutex > lock( m_mutex );
+            m_cvStart.wait( lock, [ this, lastFrame ] { return m_bQuit || m_frame != lastFrame; } );
+            if( m_bQuit )
+            {
+                return;
+            }
+            lastFrame = m_frame;
+        }
+
+        renderBand( band );
+
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            m_nBusyWorkers--;
+        }
+        m_cvDone.notify_one();
+    }
+}
+
+void BandRenderer::renderBand( const int band )
+{
+    const RectI bandRect( 0, Graphics::ScreenWidth, Graphics::ScreenHeight * band / m_nThreads, Graphics::ScreenHeight * ( band + 1 ) / m_nThreads );
+
+    const RectI oldClip = Graphics::GetClipRect();
+    for( const auto& d : m_vDirtyRects )
+    {
+        const RectI r = intersect( d, bandRect );
+        if( isEmpty( r ) )
+        {
+            continue;
+        }
+        Graphics::SetClipRect( r );
+        if( m_bDirtyTracking )
+        {
+            m_gfx.DrawRect( r, Colors::Black );     /* what BeginFrame() would have done */
+        }
+        for( const auto& c : m_vCommands )
+        {
+            if( c.bounds.IsOverlappingWith( r ) )
+            {
+                c.draw( m_gfx );
+            }
+        }
+    }
+    Graphics::SetClipRect( oldClip );
+}
+
+void BandRenderer::findDirtyRects()
+{
+    m_vDirtyTiles.assign( m_tilesX * m_tilesY, false );
+
+    const RectI screen = Graphics::GetScreenRect();
+    const Vei2 delta = m_prevWorldOffset - m_worldOffset;      /* movement of the world on the screen */
+    const bool bScrolled = delta.x != 0 || delta.y != 0;
+
+    if( m_bInvalid || abs( delta.x ) >= Graphics::ScreenWidth || abs( delta.y ) >= Graphics::ScreenHeight )
+    {
+        markDirty( screen );
+        buildDirtyRects();
+        return;
+    }
+
+    if( bScrolled )
+    {
+        m_gfx.ScrollFrame( delta.x, delta.y );
+        markDifference( screen, shift( screen, delta ) );      /* uncovered strip */
+    }
+
+    /* match the commands with the ones of the last frame (same key, same order). Matched commands only need the
+       difference of their bounds redrawn, all others their complete old and new bounds */
+    std::unordered_map< DrawKey, std::vector< int >, DrawKeyHash > prevByKey;
+    for( int i = 0; i < ( int )m_vPrevCommands.size(); ++i )
+    {
+        prevByKey[ m_vPrevCommands[ i ].key ].push_back( i );
+    }
+    std::unordered_map< DrawKey, size_t, DrawKeyHash > nextMatch;
+    std::vector< bool > vMatched( m_vPrevCommands.size(), false );
+    int lastMatch = -1;
+
+    for( const auto& c : m_vCommands )
+    {
+        int match = -1;
+        const auto it = prevByKey.find( c.key );
+        if( it != prevByKey.end() )
+        {
+            /* candidates before the last match would change the drawing order, they count as removed */
+            size_t& next = nextMatch[ c.key ];
+            while( next < it->second.size() && it->second[ next ] <= lastMatch )
+            {
+                next++;
+            }
+            if( next < it->second.size() )
+            {
+                match = it->second[ next++ ];
+            }
+        }
+
+        if( match < 0 )
+        {
+            markDirty( c.bounds );
+            continue;
+        }
+        vMatched[ match ] = true;
+        lastMatch = match;
+
+        /* old pixels of this command after the scroll shift */
+        const RectI oldBounds = shift( m_vPrevCommands[ match ].bounds, delta );
+        if( c.key.bWorld || !bScrolled )
+        {
+            markDifference( oldBounds, c.bounds );
+            markDifference( c.bounds, oldBounds );
+        }
+        else
+        {
+            /* screen layer commands stay where they are, but the frame buffer was shifted */
+            markDirty( oldBounds );
+            markDirty( c.bounds );
+        }
+    }
+    for( int i = 0; i < ( int )m_vPrevCommands.size(); ++i )
+    {
+        if( !vMatched[ i ] )
+        {
+            markDirty( shift( m_vPrevCommands[ i ].bounds, delta ) );
+        }
+    }
+
+    buildDirtyRects();
+}
+
+void BandRenderer::markDirty( const RectI& rect )
+{
+    const RectI r = intersect( rect, Graphics::GetScreenRect() );
+    if( isEmpty( r ) )
+    {
+        return;
+    }
+    for( int ty = r.top / m_tileSize; ty <= ( r.bottom - 1 ) / m_tileSize; ++ty )
+    {
+        for( int tx = r.left / m_tileSize; tx <= ( r.right - 1 ) / m_tileSize; ++tx )
+        {
+            m_vDirtyTiles[ ty * m_tilesX + tx ] = true;
+        }
+    }
+}
+
+void BandRenderer::markDifference( const RectI& a, const RectI& b )
+{
+    if( isEmpty( a ) )
+    {
+        return;
+    }
+    const RectI i = intersect( a, b );
+    if( isEmpty( i ) )
+    {
+        markDirty( a );
+        return;
+    }
+    markDirty( RectI( a.left, a.right, a.top, i.top ) );
+    markDirty( RectI( a.left, a.right, i.bottom, a.bottom ) );
+    markDirty( RectI( a.left, i.left, i.top, i.bottom ) );
+    markDirty( RectI( i.right, a.right, i.top, i.bottom ) );
+}
+
+void BandRenderer::buildDirtyRects()
+{
+    m_vDirtyRects.clear();
+
+    const int nDirty = ( int )std::count( m_vDirtyTiles.begin(), m_vDirtyTiles.end(), true );
+    m_dirtyFraction = ( float )nDirty / ( m_tilesX * m_tilesY );
+    if( nDirty == 0 )
+    {
+        return;
+    }
+    /* mostly dirty: one full redraw is cheaper than many small rects */
+    if( m_dirtyFraction > 0.6f )
+    {
+        m_vDirtyRects.push_back( Graphics::GetScreenRect() );
+        m_dirtyFraction = 1.0f;
+        return;
+    }
+
+    /* horizontal runs of dirty tiles, runs with the same extent in consecutive rows are merged */
+    std::vector< int > vOpen;       /* rects ending at the current tile row */
+    for( int ty = 0; ty < m_tilesY; ++ty )
+    {
+        std::vector< int > vNowOpen;
+        int tx = 0;
+        while( tx < m_tilesX )
+        {
+            if( !m_vDirtyTiles[ ty * m_tilesX + tx ] )
+            {
+                tx++;
+                continue;
+            }
+            const int start = tx;
+            while( tx < m_tilesX && m_vDirtyTiles[ ty * m_tilesX + tx ] )
+            {
+                tx++;
+            }
+            const RectI run( start * m_tileSize, tx * m_tileSize, ty * m_tileSize, ( ty + 1 ) * m_tileSize );
+
+            auto it = std::find_if( vOpen.begin(), vOpen.end(), [ this, &run ]( const int idx )
+            {
+                return m_vDirtyRects[ idx ].left == run.left && m_vDirtyRects[ idx ].right == run.right;
+            } );
+            if( it != vOpen.end() )
+            {
+                m_vDirtyRects[ *it ].bottom = run.bottom;
+                vNowOpen.push_back( *it );
+            }
+            else
+            {
+                m_vDirtyRects.push_back( run );
+                vNowOpen.push_back( ( int )m_vDirtyRects.size() - 1 );
+            }
+        }
+        vOpen.swap( vNowOpen );
+    }
+}
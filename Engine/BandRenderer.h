@@ -0,0 +1,121 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Graphics.h"
+#include "DrawKey.h"
+
+/* parallel software rendering: the draw calls of a frame are recorded once (Graphics::BeginRecording()), then the
+   screen is split into horizontal bands and every band replays all commands with a band-local clip rect on its own
+   thread. Commands are replayed in recording order, so the result is identical to drawing serially.
+
+   With dirty tracking the frame buffer is kept between frames: the recorded commands are compared with the ones of
+   the previous frame and only the regions where they differ are cleared and replayed. Camera scrolling (offset of
+   the world layer) shifts the old frame buffer content, so only the uncovered strip has to be drawn again */
+class BandRenderer
+{
+public:
+    BandRenderer( Graphics& gfx, const int nThreads = 1 );
+    ~BandRenderer();
+    BandRenderer( const BandRenderer& ) = delete;
+    BandRenderer& operator=( const BandRenderer& ) = delete;
+
+    void setNumThreads( const int nThreads );     /* number of bands, the calling thread renders one of them */
+    int getNumThreads() const
+    {
+        return m_nThreads;
+    }
+    void setDirtyTracking( const bool bEnable );
+    bool isDirtyTracking() const
+    {
+        return m_bDirtyTracking;
+    }
+    bool needsRecording() const                     /* false: plain serial drawing gives the same result */
+    {
+        return m_nThreads > 1 || ( m_bDirtyTracking && !isScrolling() );
+    }
+    bool keepsFrame() const                         /* true: the coming frame is drawn over the last one, no clear */
+    {
+        return m_bDirtyTracking && needsRecording();
+    }
+    /* dirty tracking: world offset of the coming frame, before it is drawn. While the camera scrolls continuously,
+       matching the commands costs more than it saves (RenderBenchmark), those frames are drawn completely */
+    void setCamera( const Vei2& camOffset );
+    void invalidate()                               /* frame buffer was changed outside of render(), redraw all */
+    {
+        m_bInvalid = true;
+    }
+
+    /* commands recorded in between are drawn relative to the camera (camOffset = world position of the screen origin) */
+    void beginWorld( const Vei2& camOffset );
+    void endWorld();
+
+    void record( DrawKey key, const RectI& bounds, std::function< void( Graphics& ) > command );
+    void render();                                  /* rasterises and clears all recorded commands */
+
+    int getCommandsLastFrame() const
+    {
+        return m_commandsLastFrame;
+    }
+    float getDirtyFraction() const                  /* part of the screen redrawn in the last frame */
+    {
+        return m_dirtyFraction;
+    }
+private:
+    bool isScrolling() const
+    {
+        return m_nScrollFrames >= 2;
+    }
+
+    struct Command
+    {
+        DrawKey key;
+        RectI bounds;                               /* screen space, clipped to the screen */
+        std::function< void( Graphics& ) > draw;
+    };
+
+    void startWorkers();
+    void stopWorkers();
+    void workerLoop( const int band, unsigned int lastFrame );
+    void renderBand( const int band );
+
+    /* dirty tracking */
+    void findDirtyRects();
+    void markDirty( const RectI& rect );
+    void markDifference( const RectI& a, const RectI& b );     /* parts of a not covered by b */
+    void buildDirtyRects();
+
+    Graphics& m_gfx;
+    int m_nThreads = 1;
+    std::vector< Command > m_vCommands;
+    std::vector< Command > m_vPrevCommands;         /* last frame, for dirty tracking */
+    int m_commandsLastFrame = 0;
+
+    bool m_bInWorld = false;
+    Vei2 m_worldOffset = { 0, 0 };
+    Vei2 m_prevWorldOffset = { 0, 0 };
+
+    Vei2 m_camera = { 0, 0 };                       /* setCamera() */
+    int m_nScrollFrames = 0;                        /* consecutive frames with a moving camera */
+
+    bool m_bDirtyTracking = false;
+    bool m_bInvalid = true;
+    static constexpr int m_tileSize = 20;           /* granularity of the dirty regions */
+    static constexpr int m_tilesX = Graphics::ScreenWidth / m_tileSize;
+    static constexpr int m_tilesY = Graphics::ScreenHeight / m_tileSize;
+    static_assert( Graphics::ScreenWidth % m_tileSize == 0 && Graphics::ScreenHeight % m_tileSize == 0, "dirty tiles have to fit the screen" );
+    std::vector< bool > m_vDirtyTiles;
+    std::vector< RectI > m_vDirtyRects;             /* rendered by the bands */
+    float m_dirtyFraction = 1.0f;
+
+    /* workers render bands 1..n-1, band 0 is done by the thread calling render() */
+    std::vector< std::thread > m_vWorkers;
+    std::mutex m_mutex;
+    std::condition_variable m_cvStart;
+    std::condition_variable m_cvDone;
+    unsigned int m_frame = 0;                       /* incremented for every render() call to start the workers */
+    int m_nBusyWorkers = 0;
+    bool m_bQuit = false;
+};
@@ -0,0 +1,138 @@
+#include "BlitBenchmark.h"
+#include "SpriteEffect.h"
+#include "ChiliWin.h"
+#include <chrono>
+#include <algorithm>
+
+namespace
+{
+    /* reference: effect called once per pixel, like DrawSprite did before the row kernels */
+    template< typename E >
+    void drawPerPixel( Graphics& gfx, const int x, const int y, const RectI& srcRect, const Surface& s, E effect )
+    {
+        for( int sy = srcRect.top; sy < srcRect.bottom; sy++ )
+        {
+            for( int sx = srcRect.left; sx < srcRect.right; sx++ )
+            {
+                effect( s.GetPixel( sx, sy ), x + sx - srcRect.left, y + sy - srcRect.top, gfx );
+            }
+        }
+    }
+
+    /* blits srcRect nBlits times over the whole screen, returns mega pixels per second */
+    template< typename E >
+    float measure( Graphics& gfx, const RectI& srcRect, const Surface& s, E effect, const int nBlits, const bool perPixel )
+    {
+        const int w = srcRect.GetWidth();
+        const int h = srcRect.GetHeight();
+        const int nCols = std::max( Graphics::ScreenWidth / w, 1 );
+        const int nRows = std::max( Graphics::ScreenHeight / h, 1 );
+
+        const auto start = std::chrono::steady_clock::now();
+        for( int i = 0; i < nBlits; ++i )
+        {
+            const int x = ( i % nCols ) * w;
+            const int y = ( ( i / nCols ) % nRows ) * h;
+            if( perPixel )
+            {
+                drawPerPixel( gfx, x, y, srcRect, s, effect );
+            }
+            else
+            {
+                gfx.DrawSprite( x, y, srcRect, s, effect );
+            }
+        }
+        const std::chrono::duration< float > elapsed = std::chrono::steady_clock::now() - start;
+
+        return ( float )w * h * nBlits / std::max( elapsed.count(), 1e-6f ) / 1e6f;
+    }
+
+    template< typename E >
+    std::string compare( const std::string& name, Graphics& gfx, const RectI& srcRect, const Surface& s, E effect, const int nBlits )
+    {
+        const float reference = measure( gfx, srcRect, s, effect, nBlits, true );
+        const float rows      = measure( gfx, srcRect, s, effect, nBlits, false );
+
+        char buffer[ 128 ];
+        sprintf_s( buffer, "%-8s %4.0f Mpx/s (per pixel %4.0f, x%.1f)", name.c_str(), rows, reference, rows / std::max( reference, 1e-6f ) );
+        return buffer;
+    }
+
+    /* chroma keyed sprite, run-length encoded (RleSprite) or palette indexed (IndexedSprite). draw( x, y ) blits it once */
+    template< typename S, typename F >
+    std::string measureSpans( const std::string& name, const RectI& srcRect, const S& s, const int nBlits, F draw )
+    {
+        const int w = srcRect.GetWidth();
+        const int h = srcRect.GetHeight();
+        const int nCols = std::max( Graphics::ScreenWidth / w, 1 );
+        const int nRows = std::max( Graphics::ScreenHeight / h, 1 );
+
+        const auto start = std::chrono::steady_clock::now();
+        for( int i = 0; i < nBlits; ++i )
+        {
+            draw( ( i % nCols ) * w, ( ( i / nCols ) % nRows ) * h );
+        }
+        const std::chrono::duration< float > elapsed = std::chrono::steady_clock::now() - start;
+        const float mpx = ( float )w * h * nBlits / std::max( elapsed.count(), 1e-6f ) / 1e6f;
+
+        char buffer[ 128 ];
+        sprintf_s( buffer, "%-8s %4.0f Mpx/s (%d%% opaque, %.1f KB)", name.c_str(), mpx, 100 * s.GetNumOpaquePixels() / ( s.GetWidth() * s.GetHeight() ),
+                   s.GetMemoryUsage() / 1024.0f );
+        return buffer;
+    }
+}
+
+std::vector< std::string > BlitBenchmark::run( Graphics& gfx, const Surface& unitSprite, const Surface& levelImg )
+{
+    std::vector< std::string > vLines;
+
+    const RectI unitRect( 0, std::min( 40, unitSprite.GetWidth() ), 0, std::min( 40, unitSprite.GetHeight() ) );
+    const int nUnitBlits = 20000;
+    vLines.push_back( "40x40 sprites:" );
+    vLines.push_back( compare( "copy", gfx, unitRect, unitSprite, SpriteEffect::Copy{}, nUnitBlits ) );
+    vLines.push_back( compare( "chroma", gfx, unitRect, unitSprite, SpriteEffect::Chroma( Colors::White ), nUnitBlits ) );
+    vLines.push_back( compare( "subst", gfx, unitRect, unitSprite, SpriteEffect::Substitution( Colors::White, Colors::Red ), nUnitBlits ) );
+    vLines.push_back( compare( "team", gfx, unitRect, unitSprite, SpriteEffect::TeamColor( Colors::White, { 255, 242, 0 }, Colors::Blue ), nUnitBlits ) );
+    vLines.push_back( compare( "ghost", gfx, unitRect, unitSprite, SpriteEffect::Ghost( Colors::White ), nUnitBlits ) );
+    {
+        /* same look as the ghost, premultiplied alpha instead of the chroma key */
+        const Surface alphaSprite = unitSprite.Premultiplied( unitRect, Colors::White, 128 );
+        vLines.push_back( compare( "alpha", gfx, alphaSprite.GetRect(), alphaSprite, SpriteEffect::AlphaBlend(), nUnitBlits ) );
+    }
+    {
+        /* whole sheet encoded, memory of all 8 directions. The indexed sprite is drawn through a team palette swap */
+        const RleSprite rle( unitSprite, Colors::White );
+        const IndexedSprite indexed( unitSprite, Colors::White, { { 255, 242, 0 } } );
+        const Palette team = indexed.GetPalette().Substituted( { 255, 242, 0 }, Colors::Blue );
+        vLines.push_back( measureSpans( "rle", unitRect, rle, nUnitBlits, [ & ]( int x, int y ) { gfx.DrawSprite( x, y, unitRect, rle ); } ) );
+        vLines.push_back( measureSpans( "indexed", unitRect, indexed, nUnitBlits, [ & ]( int x, int y ) { gfx.DrawSprite( x, y, unitRect, indexed, team ); } ) );
+        char buffer[ 128 ];
+        sprintf_s( buffer, "%-8s %d colours -> %d palette entries", "", indexed.GetNumSourceColors(), indexed.GetPalette().GetNumUsed() - 1 );
+        vLines.push_back( buffer );
+    }
+
+    const RectI levelRect( 0, std::min( Graphics::ScreenWidth, levelImg.GetWidth() ), 0, std::min( Graphics::ScreenHeight, levelImg.GetHeight() ) );
+    vLines.push_back( "level background:" );
+    vLines.push_back( compare( "copy", gfx, levelRect, levelImg, SpriteEffect::Copy{}, 200 ) );
+    {
+        /* opaque fast path used by Level::draw() */
+        const int nBlits = 200;
+        const auto start = std::chrono::steady_clock::now();
+        for( int i = 0; i < nBlits; ++i )
+        {
+            gfx.DrawOpaque( 0, 0, levelRect, levelImg );
+        }
+        const std::chrono::duration< float > elapsed = std::chrono::steady_clock::now() - start;
+        const float mpx = ( float )levelRect.GetWidth() * levelRect.GetHeight() * nBlits / std::max( elapsed.count(), 1e-6f ) / 1e6f;
+
+        char buffer[ 128 ];
+        sprintf_s( buffer, "%-8s %4.0f Mpx/s", "opaque", mpx );
+        vLines.push_back( buffer );
+    }
+
+    for( const auto& l : vLines )
+    {
+        OutputDebugStringA( ( l + "\n" ).c_str() );
+    }
+    return vLines;
+}
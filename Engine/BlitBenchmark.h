@@ -0,0 +1,14 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "Graphics.h"
+#include "Surface.h"
+
+/* measures the sprite blitting throughput (mega pixels per second) of all sprite effects, row kernels
+   (Graphics::DrawSprite) compared to the per pixel operator() of the effects. Overwrites the frame buffer! */
+class BlitBenchmark
+{
+public:
+    /* unitSprite: sprite sheet of a unit, the first 40x40 pixels are used. levelImg: blitted screen-filling */
+    static std::vector< std::string > run( Graphics& gfx, const Surface& unitSprite, const Surface& levelImg );
+};
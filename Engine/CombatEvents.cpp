@@ -0,0 +1,24 @@
+#include "CombatEvents.h"
+#include "Unit.h"
+#include "UnitActivity.h"
+#include "EffectPool.h"
+
+void CombatEventQueue::resolve( UnitActivity& activity, EffectPool& effects, const int impactClip )
+{
+    m_nEventsLastTick = ( int )m_vEvents.size();
+
+    for( const auto& e : m_vEvents )
+    {
+        e.pAttacker->playSound( Unit::SoundOrder::ATTACK );
+
+        /* several shots can hit the same target in one tick, the ones after its death are dropped */
+        if( !e.pTarget->isDestroyed() )
+        {
+            activity.wake( e.pTarget );
+            e.pTarget->takeDamage( e.damage, e.attackerType, e.pAttacker );
+            /* a few pixels around the center, hits on the same target do not stack */
+            effects.spawn( impactClip, e.pTarget->getLocationInt() + Vei2( rand() % 9 - 4, rand() % 9 - 4 ), Unit::getShotTravelTime() );
+        }
+    }
+    m_vEvents.clear();
+}
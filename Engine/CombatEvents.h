@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+
+class Unit;
+class UnitActivity;
+class EffectPool;
+enum class UnitType;
+
+struct DamageEvent
+{
+    Unit* pTarget;
+    Unit* pAttacker;
+    int damage;
+    UnitType attackerType;
+};
+
+/* collects the damage of all shots fired during the unit updates and applies it afterwards in one pass,
+   so no unit gets mutated by another one in the middle of the update loop */
+class CombatEventQueue
+{
+public:
+    CombatEventQueue()
+    {
+        m_vEvents.reserve( 256 );
+    }
+
+    void pushDamage( Unit* const pTarget, Unit* const pAttacker, const int damage, const UnitType attackerType )
+    {
+        m_vEvents.push_back( { pTarget, pAttacker, damage, attackerType } );
+    }
+    /* applies all queued events (damage, death, sounds, retaliation), damaged units are woken up. Every hit spawns
+       an impactClip effect, delayed until the drawn shot arrives */
+    void resolve( UnitActivity& activity, EffectPool& effects, const int impactClip );
+    void clear()
+    {
+        m_vEvents.clear();
+        m_nEventsLastTick = 0;
+    }
+
+    int getEventsLastTick() const
+    {
+        return m_nEventsLastTick;
+    }
+private:
+    std::vector< DamageEvent > m_vEvents;
+    int m_nEventsLastTick = 0;
+};
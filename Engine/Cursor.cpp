@@ -1,16 +1,17 @@
 #include "Cursor.h"
-#include "SpriteEffect.h"
 
-Cursor::Cursor( Graphics& gfx, const Mouse& mouse, const std::vector< Unit* >& vpUnits, const Level& level, const RectF& scrollRect, const int actionBarWidth )
+Cursor::Cursor( Graphics& gfx, AssetManager& assets, const Mouse& mouse, const std::vector< Unit* >& vpUnits, const Level& level, const VisibilityGrid& visibility,
+                const RectF& scrollRect, const int actionBarWidth )
     :
-    m_mainSprite( "..\\images\\cursor\\cursor.bmp" ),
-    m_forbiddenSprite( "..\\images\\cursor\\forbidden.bmp" ),
-    m_arrowSprites( "..\\images\\cursor\\arrows.bmp" ),
-    m_arrow4directions( "..\\images\\cursor\\4_arrows.bmp" ),
+    m_mainSprite( assets.getSprite( "..\\images\\cursor\\cursor.bmp" ).makeIndexed( { 255, 242, 0 } ) ),
+    m_forbiddenSprite( assets.getSprite( "..\\images\\cursor\\forbidden.bmp" ).makeIndexed( Colors::White ) ),
+    m_arrowSprites( assets.getSprite( "..\\images\\cursor\\arrows.bmp" ).makeRle( Colors::White ) ),
+    m_arrow4directions( assets.getSprite( "..\\images\\cursor\\4_arrows.bmp" ).makeRle( Colors::Black ) ),
     m_gfx( gfx ),
     m_mouse( mouse ),
     m_vpUnits( vpUnits ),
     m_level (level ),
+    m_visibility( visibility ),
     m_scrollingRect( scrollRect )
 {
     m_actionBarWidth = actionBarWidth;
@@ -25,9 +26,6 @@ Cursor::Cursor( Graphics& gfx, const Mouse& mouse, const std::vector< Unit* >& v
 
 void Cursor::update( const float dt, const Vei2& camPos )
 {
-    const Vei2 halfScreen( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
-    const Vei2 offset = camPos - halfScreen;
-
     /* check if at least one unit is selected */
     m_bUnitSelected = false;
     for( const auto& u : m_vpUnits )
@@ -50,8 +48,7 @@ void Cursor::update( const float dt, const Vei2& camPos )
             continue;
         }
     
-        RectF bb = u->getBoundigBox(); 
-        m_rectFromUnit = RectF( bb.left - offset.x, bb.right - offset.x, bb.top - offset.y, bb.bottom - offset.y );
+        m_rectFromUnit = m_level.worldToScreen( u->getBoundigBox(), camPos );
         if( m_rectFromUnit.Contains( mp ) )
         {
             if( u->getTeam() != Team::_A )
@@ -68,12 +65,11 @@ void Cursor::update( const float dt, const Vei2& camPos )
     {
         for( const auto &u : m_vpUnits )
         {
-            if( u->getTeam() == Team::_A )
+            if( u->getTeam() == Team::_A || !m_visibility.isVisible( Team::_A, u->getTileIdx() ) )
             {
                 continue;
             }
-            RectF bb = u->getBoundigBox();
-            m_rectFromUnit = RectF( bb.left - offset.x, bb.right - offset.x, bb.top - offset.y, bb.bottom - offset.y );
+            m_rectFromUnit = m_level.worldToScreen( u->getBoundigBox(), camPos );
             if( m_rectFromUnit.Contains( mp ) )
             {
                 m_bMouseOverUnit = true;
@@ -122,7 +118,7 @@ void Cursor::draw( const Vei2& camPos, bool bScrollingPressed, bool bSelectingRe
     
     if( bScrollingPressed )
     {
-        m_gfx.DrawSprite( x - m_arrow4directions.GetWidth() / 2, y - m_arrow4directions.GetHeight() / 2, m_arrow4directions, SpriteEffect::Chroma( Colors::Black ) );
+        m_gfx.DrawSprite( x - m_arrow4directions.GetWidth() / 2, y - m_arrow4directions.GetHeight() / 2, m_arrow4directions );
         return;
     }
     
@@ -131,29 +127,36 @@ void Cursor::draw( const Vei2& camPos, bool bScrollingPressed, bool bSelectingRe
     /* scrolling arrows */
     if( !bSelectingRectangle && !r.Contains( m_mouse.GetPos() ) )
     {
+        /* directions the camera can still move to (it is clamped to the level at the current zoom) */
+        const int s = m_level.getZoomScale();
+        const bool bLeft    = m_level.clampCamera( camPos - Vei2( s, 0 ) ).x < camPos.x;
+        const bool bRight   = m_level.clampCamera( camPos + Vei2( s, 0 ) ).x > camPos.x;
+        const bool bUp      = m_level.clampCamera( camPos - Vei2( 0, s ) ).y < camPos.y;
+        const bool bDown    = m_level.clampCamera( camPos + Vei2( 0, s ) ).y > camPos.y;
+
         if( x < r.left )
         {
             if( y < r.top )
             {
-                if( camPos.x > Graphics::halfScreenWidth || camPos.y > Graphics::halfScreenHeight )
+                if( bLeft || bUp )
                 {
-                    m_gfx.DrawSprite( 0, 0, m_vArrowSpriteRects[ ( int )Direction::UP_LEFT ], m_arrowSprites, SpriteEffect::Chroma( Colors::White ) );
+                    m_gfx.DrawSprite( 0, 0, m_vArrowSpriteRects[ ( int )Direction::UP_LEFT ], m_arrowSprites );
                     return;
                 }
             }
             else if( y > r.bottom )
             {
-                if( camPos.x > Graphics::halfScreenWidth || camPos.y < m_level.getHeight() - Graphics::halfScreenHeight )
+                if( bLeft || bDown )
                 {
-                    m_gfx.DrawSprite( 0, Graphics::ScreenHeight - m_arrowWidth, m_vArrowSpriteRects[ ( int )Direction::DOWN_LEFT ], m_arrowSprites, SpriteEffect::Chroma( Colors::White ) );
+                    m_gfx.DrawSprite( 0, Graphics::ScreenHeight - m_arrowWidth, m_vArrowSpriteRects[ ( int )Direction::DOWN_LEFT ], m_arrowSprites );
                     return;
                 }
             }
             else
             {
-                if( camPos.x > Graphics::halfScreenWidth )
+                if( bLeft )
                 {
-                    m_gfx.DrawSprite( 5, y - m_arrowHeight / 2, m_vArrowSpriteRects[ ( int )Direction::LEFT ], m_arrowSprites, SpriteEffect::Chroma( Colors::White ) );
+                    m_gfx.DrawSprite( 5, y - m_arrowHeight / 2, m_vArrowSpriteRects[ ( int )Direction::LEFT ], m_arrowSprites );
                     return;
                 }
             }
@@ -162,43 +165,43 @@ void Cursor::draw( const Vei2& camPos, bool bScrollingPressed, bool bSelectingRe
         {
             if( y < r.top )
             {
-                if( camPos.x < m_level.getWidth() + m_level.getActionBarWidth() - Graphics::halfScreenWidth || camPos.y > Graphics::halfScreenHeight )
+                if( bRight || bUp )
                 {
-                    m_gfx.DrawSprite( Graphics::ScreenWidth - m_arrowWidth, 0, m_vArrowSpriteRects[ ( int )Direction::UP_RIGHT ], m_arrowSprites, SpriteEffect::Chroma( Colors::White ) );
+                    m_gfx.DrawSprite( Graphics::ScreenWidth - m_arrowWidth, 0, m_vArrowSpriteRects[ ( int )Direction::UP_RIGHT ], m_arrowSprites );
                     return;
                 }
             }
             else if( y > r.bottom )
             {
-                if( camPos.x < m_level.getWidth() + m_level.getActionBarWidth() - Graphics::halfScreenWidth || camPos.y < m_level.getHeight() - Graphics::halfScreenHeight )
+                if( bRight || bDown )
                 {
                     m_gfx.DrawSprite( Graphics::ScreenWidth - m_arrowWidth, Graphics::ScreenHeight - m_arrowHeight,
-                                      m_vArrowSpriteRects[ ( int )Direction::DOWN_RIGHT ], m_arrowSprites, SpriteEffect::Chroma( Colors::White ) );
+                                      m_vArrowSpriteRects[ ( int )Direction::DOWN_RIGHT ], m_arrowSprites );
                     return;
                 }
             }
             else
             {
-                if( camPos.x < m_level.getWidth() + m_level.getActionBarWidth() - Graphics::halfScreenWidth )
+                if( bRight )
                 {
-                    m_gfx.DrawSprite( Graphics::ScreenWidth - m_arrowWidth, y - m_arrowHeight / 2, m_vArrowSpriteRects[ ( int )Direction::RIGHT ], m_arrowSprites, SpriteEffect::Chroma( Colors::White ) );
+                    m_gfx.DrawSprite( Graphics::ScreenWidth - m_arrowWidth, y - m_arrowHeight / 2, m_vArrowSpriteRects[ ( int )Direction::RIGHT ], m_arrowSprites );
                     return;
                 }
             }
         }
         else if( y < r.top )
         {
-            if( camPos.y > Graphics::halfScreenHeight )
+            if( bUp )
             {
-                m_gfx.DrawSprite( x - m_arrowWidth / 2, 0, m_vArrowSpriteRects[ ( int )Direction::UP ], m_arrowSprites, SpriteEffect::Chroma( Colors::White ) );
+                m_gfx.DrawSprite( x - m_arrowWidth / 2, 0, m_vArrowSpriteRects[ ( int )Direction::UP ], m_arrowSprites );
                 return;
             }
         }
         else if( y > r.bottom )
         {
-            if( camPos.y < m_level.getHeight() - Graphics::halfScreenHeight )
+            if( bDown )
             {
-                m_gfx.DrawSprite( x - m_arrowWidth / 2, Graphics::ScreenHeight - m_arrowHeight, m_vArrowSpriteRects[ ( int )Direction::DOWN ], m_arrowSprites, SpriteEffect::Chroma( Colors::White ) );
+                m_gfx.DrawSprite( x - m_arrowWidth / 2, Graphics::ScreenHeight - m_arrowHeight, m_vArrowSpriteRects[ ( int )Direction::DOWN ], m_arrowSprites );
                 return;
             }
         }
@@ -206,13 +209,10 @@ void Cursor::draw( const Vei2& camPos, bool bScrollingPressed, bool bSelectingRe
 
     if( x > Graphics::ScreenWidth - m_actionBarWidth )
     {
-        m_gfx.DrawSprite( x, y, m_mainSprite, SpriteEffect::Chroma( { 255, 242, 0 } ) );
+        m_gfx.DrawSprite( x, y, m_mainSprite );
         return;
     }
 
-    const Vei2 halfScreen( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
-    const Vei2 offset = camPos - halfScreen;
-        
     if( m_bUnitSelected )
     {
         if( m_bMouseOverEnemy )
@@ -224,9 +224,9 @@ void Cursor::draw( const Vei2& camPos, bool bScrollingPressed, bool bSelectingRe
             return;
         }
 
-        if( m_bSelectedGroundUnit && Tile::OBSTACLE == m_level.getTileType( x + offset.x, y + offset.y ) )
+        if( m_bSelectedGroundUnit && Tile::OBSTACLE == m_level.getTileType( m_level.getTileIdx( m_level.screenToWorld( m_mouse.GetPos(), camPos ) ) ) )
         {
-            m_gfx.DrawSprite( x - m_forbiddenSprite.GetWidth() / 2, y - m_forbiddenSprite.GetHeight() / 2, m_forbiddenSprite, SpriteEffect::Chroma( Colors::White ) );
+            m_gfx.DrawSprite( x - m_forbiddenSprite.GetWidth() / 2, y - m_forbiddenSprite.GetHeight() / 2, m_forbiddenSprite );
             m_animationIdx = 0;
             m_animationTime = 0;
             return;
@@ -250,7 +250,7 @@ void Cursor::draw( const Vei2& camPos, bool bScrollingPressed, bool bSelectingRe
         m_cursorBlinkTime = 0;
     }
 
-    m_gfx.DrawSprite( x, y, m_mainSprite, SpriteEffect::Chroma( { 255, 242, 0 } ) );
+    m_gfx.DrawSprite( x, y, m_mainSprite );
 }
 
 void Cursor::advanceAnimation()
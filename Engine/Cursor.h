@@ -3,19 +3,22 @@
 #include "Level.h"
 #include "Unit.h"
 #include "Mouse.h"
+#include "VisibilityGrid.h"
+#include "AssetManager.h"
 
 class Cursor
 {
 public:
-    Cursor( Graphics& gfx, const Mouse& mouse, const std::vector< Unit* >& vpUnits, const Level& level, const RectF& scrollRect, const int actionBarWidth );
+    Cursor( Graphics& gfx, AssetManager& assets, const Mouse& mouse, const std::vector< Unit* >& vpUnits, const Level& level,
+            const VisibilityGrid& visibility, const RectF& scrollRect, const int actionBarWidth );
 
     void update( const float dt, const Vei2& camPos );
     void draw( const Vei2& camPos, bool bScrollingPressed = false, bool bSelectingRectangle = false );
 private:
-    const Surface m_mainSprite;
-    const Surface m_forbiddenSprite;
-    const Surface m_arrowSprites;
-    const Surface m_arrow4directions;
+    const IndexedSprite m_mainSprite;           /* few colours: palette indexed */
+    const IndexedSprite m_forbiddenSprite;
+    const RleSprite m_arrowSprites;
+    const RleSprite m_arrow4directions;
     std::vector< RectI > m_vArrowSpriteRects;
     int m_arrowWidth;
     int m_arrowHeight;
@@ -42,6 +45,7 @@ private:
     const Mouse& m_mouse;
     const std::vector< Unit* >& m_vpUnits;
     const Level& m_level;
+    const VisibilityGrid& m_visibility;     /* only visible enemies can be hovered */
 
     const RectF& m_scrollingRect;
 };
\ No newline at end of file
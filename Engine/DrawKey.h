@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+
+/* identifies a recorded draw call. Two calls with the same key produce the same pixel at every screen position
+   inside both of their bounds, so only the difference of the bounds has to be redrawn (see BandRenderer) */
+struct DrawKey
+{
+    enum class Type
+    {
+        PIXEL = 0,
+        LINE,
+        THICK_LINE,
+        HSPAN,
+        RECT,
+        CIRCLE,
+        CIRCLE_BORDER,
+        SPRITE,             /* sprites: anchor = screen position of the surface origin, the src rect is irrelevant */
+        RLE_SPRITE,
+        INDEXED_SPRITE,
+        OPAQUE
+    };
+
+    DrawKey( const Type t, const int xAnchor, const int yAnchor )
+        :
+        type( t ),
+        x( xAnchor ),
+        y( yAnchor )
+    {
+    }
+    /* copies the parameters of a sprite effect (small classes holding colours only) */
+    template< typename E >
+    void setEffect( const E& effect )
+    {
+        static_assert( sizeof( E ) <= sizeof( data ), "sprite effect too large for DrawKey" );
+        static const char id = 0;   /* one address per effect type */
+        pEffect = &id;
+        memcpy( data, &effect, sizeof( E ) );
+    }
+
+    bool operator==( const DrawKey& rhs ) const
+    {
+        return type == rhs.type && x == rhs.x && y == rhs.y && bWorld == rhs.bWorld
+            && pSource == rhs.pSource && pEffect == rhs.pEffect
+            && memcmp( params, rhs.params, sizeof( params ) ) == 0 && memcmp( data, rhs.data, sizeof( data ) ) == 0;
+    }
+    size_t hash() const
+    {
+        size_t h = ( size_t )type;
+        const auto combine = [ &h ]( const size_t v ) { h ^= v + 0x9e3779b9 + ( h << 6 ) + ( h >> 2 ); };
+        combine( ( size_t )x );
+        combine( ( size_t )y );
+        combine( ( size_t )pSource );
+        for( const int p : params )
+        {
+            combine( ( size_t )p );
+        }
+        for( const unsigned int d : data )
+        {
+            combine( d );
+        }
+        return h;
+    }
+
+    Type type;
+    int x;                          /* anchor, screen space while recording (world space in the world layer) */
+    int y;
+    bool bWorld = false;            /* anchor converted to world space by BandRenderer::record() */
+    int params[ 4 ] = {};           /* sizes relative to the anchor */
+    const void* pSource = nullptr;  /* surface or rle sprite */
+    const void* pEffect = nullptr;  /* sprite effect type */
+    unsigned int data[ 4 ] = {};    /* colour or sprite effect parameters */
+};
@@ -0,0 +1,90 @@
+#include "EffectPool.h"
+#include <cassert>
+#include <algorithm>
+#include "SpriteEffect.h"
+
+int EffectPool::addClip( const Surface& sheet, const int nFramesX, const int nFramesY, const float holdTime, const float fadeStart,
+                         const std::vector< const RleSprite* >& vZoomSprites )
+{
+    assert( nFramesX >= 1 && nFramesY >= 1 && holdTime > 0.0f );
+    assert( fadeStart >= 0.0f && fadeStart < 1.0f );
+    assert( sheet.HasAlpha() );
+    assert( m_vClips.size() < 0xffff );
+    const int frameWidth = sheet.GetWidth() / nFramesX;
+    const int frameHeight = sheet.GetHeight() / nFramesY;
+    assert( sheet.GetWidth() % frameWidth == 0 );
+    assert( sheet.GetHeight() % frameHeight == 0 );
+
+    Clip clip;
+    clip.pSheet         = &sheet;
+    clip.vZoomSprites   = vZoomSprites;
+    clip.nFramesX       = nFramesX;
+    clip.nFramesY       = nFramesY;
+    clip.halfWidth      = frameWidth / 2;
+    clip.halfHeight     = frameHeight / 2;
+    clip.invHoldTime    = 1.0f / holdTime;
+    clip.duration       = holdTime * nFramesX * nFramesY;
+    clip.fadeStart      = clip.duration * fadeStart;
+    for( int y = 0; y < nFramesY; ++y )
+    {
+        for( int x = 0; x < nFramesX; ++x )
+        {
+            clip.vFrameRects.emplace_back( Vei2( x * frameWidth, y * frameHeight ), frameWidth, frameHeight );
+        }
+    }
+    m_vClips.push_back( std::move( clip ) );
+    return ( int )m_vClips.size() - 1;
+}
+
+void EffectPool::update( const float dt )
+{
+    /* compaction in place: the finished effects are dropped, the order of the running ones (drawing order) is kept */
+    size_t nAlive = 0;
+    for( size_t i = 0; i < m_vEffects.size(); ++i )
+    {
+        Effect e = m_vEffects[ i ];
+        const Clip& clip = m_vClips[ e.clip ];
+        e.time += dt;
+        if( e.time >= clip.duration )
+        {
+            continue;
+        }
+        e.frame = ( unsigned short )std::min( std::max( ( int )( e.time * clip.invHoldTime ), 0 ), ( int )clip.vFrameRects.size() - 1 );
+        m_vEffects[ nAlive++ ] = e;
+    }
+    m_vEffects.resize( nAlive );
+}
+
+RectI EffectPool::getBounds( const Effect& e ) const
+{
+    const Clip& clip = m_vClips[ e.clip ];
+    return RectI( e.pos.x - clip.halfWidth, e.pos.x + clip.halfWidth + 1, e.pos.y - clip.halfHeight, e.pos.y + clip.halfHeight + 1 );
+}
+
+void EffectPool::draw( Graphics& gfx, const Effect& e, const Vei2& camOffset ) const
+{
+    assert( isStarted( e ) );
+    const Clip& clip = m_vClips[ e.clip ];
+
+    /* full opacity up to the start of the fade, then linear down to the end of the clip */
+    const int opacity = e.time < clip.fadeStart ? 255 : ( int )( 255.0f * ( clip.duration - e.time ) / ( clip.duration - clip.fadeStart ) );
+    const Vei2 pos = e.pos - camOffset;
+    gfx.DrawSprite( pos.x - clip.halfWidth, pos.y - clip.halfHeight, clip.vFrameRects[ e.frame ], *clip.pSheet,
+                    SpriteEffect::AlphaBlend( ( unsigned char )std::max( opacity, 0 ) ) );
+}
+
+void EffectPool::drawZoomed( Graphics& gfx, const Effect& e, const Vei2& offset, const int zoom ) const
+{
+    assert( isStarted( e ) );
+    const Clip& clip = m_vClips[ e.clip ];
+    if( zoom >= ( int )clip.vZoomSprites.size() || !clip.vZoomSprites[ zoom ] )
+    {
+        return;
+    }
+    const RleSprite& sprite = *clip.vZoomSprites[ zoom ];
+    const int frameWidth = sprite.GetWidth() / clip.nFramesX;
+    const int frameHeight = sprite.GetHeight() / clip.nFramesY;
+    const RectI r( { ( e.frame % clip.nFramesX ) * frameWidth, ( e.frame / clip.nFramesX ) * frameHeight }, frameWidth, frameHeight );
+    const Vei2 pos = e.pos / ( 1 << zoom ) - offset;
+    gfx.DrawSprite( pos.x - frameWidth / 2, pos.y - frameHeight / 2, r, sprite );
+}
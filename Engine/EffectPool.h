@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+#include "Graphics.h"
+#include "RleSprite.h"
+#include "RectI.h"
+#include "Vei2.h"
+
+/* short animations (explosions, impacts): the frames and the timing of a clip are defined once per sheet, a running
+   effect is a small POD (clip, position, time) in one contiguous pool. Spawning does not allocate once the pool has
+   reached its peak size, update() advances all effects and removes the finished ones in one pass */
+class EffectPool
+{
+public:
+    struct Effect
+    {
+        Vei2 pos;                   /* world position of the frame center */
+        float time;                 /* seconds since the start, negative while delayed */
+        unsigned short clip;
+        unsigned short frame;
+    };
+public:
+    EffectPool()
+    {
+        m_vEffects.reserve( 1024 );
+    }
+
+    /* sheet: premultiplied alpha (SpriteCache::getPremultiplied()), shared by all effects of the clip, nFramesX * nFramesY
+       frames row by row, each shown holdTime seconds. The clip fades out linearly from fadeStart (fraction of its duration).
+       vZoomSprites: the sheet scaled down per zoom level (SpriteCache::getRle( region, chroma, div, nCells )), null entries
+       and missing levels are not drawn. Returns the clip id */
+    int addClip( const Surface& sheet, const int nFramesX, const int nFramesY, const float holdTime, const float fadeStart = 2.0f / 3.0f,
+                 const std::vector< const RleSprite* >& vZoomSprites = {} );
+    void spawn( const int clip, const Vei2& pos, const float delay = 0.0f )
+    {
+        m_vEffects.push_back( { pos, -delay, ( unsigned short )clip, 0 } );
+    }
+    void update( const float dt );
+    void clear()                        /* running effects only, the clips stay */
+    {
+        m_vEffects.clear();
+    }
+
+    const std::vector< Effect >& getEffects() const
+    {
+        return m_vEffects;
+    }
+    bool isStarted( const Effect& e ) const
+    {
+        return e.time >= 0.0f;
+    }
+    RectI getBounds( const Effect& e ) const;      /* world pixels covered by the frames */
+
+    /* camOffset: world position of the screen origin */
+    void draw( Graphics& gfx, const Effect& e, const Vei2& camOffset ) const;
+    /* zoom level > 0, offset: zoomed position of the screen origin (level pixels / 2^zoom) */
+    void drawZoomed( Graphics& gfx, const Effect& e, const Vei2& offset, const int zoom ) const;
+private:
+    struct Clip
+    {
+        const Surface* pSheet;
+        std::vector< RectI > vFrameRects;
+        std::vector< const RleSprite* > vZoomSprites;
+        int nFramesX;
+        int nFramesY;
+        int halfWidth;              /* for drawing the frames centered */
+        int halfHeight;
+        float invHoldTime;
+        float duration;             /* seconds */
+        float fadeStart;            /* seconds */
+    };
+    std::vector< Clip > m_vClips;
+    std::vector< Effect > m_vEffects;
+};
@@ -1,48 +1,169 @@
 #include "Font.h"
-#include "SpriteEffect.h"
 #include <cassert>
+#include <cstdio>
+#include <algorithm>
 
-Font::Font( const std::string& filename, Color chroma )
+Font::Font( const SpriteAtlas::Region& sheet, Color chroma, int cacheSize )
     :
-    surface( filename ),
+    surface( *sheet.pPage ),
+    sheetRect( sheet.rect ),
     // calculate glyph dimensions from bitmap dimensions
-    glyphWidth( surface.GetWidth() / nColumns ),
-    glyphHeight( surface.GetHeight() / nRows ),
-    chroma( chroma )
+    glyphWidth( sheetRect.GetWidth() / nColumns ),
+    glyphHeight( sheetRect.GetHeight() / nRows ),
+    chroma( chroma ),
+    cacheSize( cacheSize )
 {
     // verify that bitmap had valid dimensions
-    assert( glyphWidth * nColumns == surface.GetWidth() );
-    assert( glyphHeight * nRows == surface.GetHeight() );
+    assert( sheetRect.IsContainedBy( surface.GetRect() ) );
+    assert( glyphWidth * nColumns == sheetRect.GetWidth() );
+    assert( glyphHeight * nRows == sheetRect.GetHeight() );
+    assert( cacheSize > 0 );
 }
 
 void Font::DrawText( const std::string& text, const Vei2& pos, Color color, Graphics& gfx ) const
 {
-    // create effect functor
-    SpriteEffect::Substitution e{ chroma,color };
-    // curPos is the pos that we are drawing to on the screen
+    if( text.empty() )
+    {
+        return;
+    }
+    gfx.DrawSprite( pos.x, pos.y, GetCachedText( text, color, gfx.GetFrameNumber() ) );
+}
+
+const RleSprite& Font::GetCachedText( const std::string& text, Color color, unsigned int frame ) const
+{
+    std::string key( ( const char* )&color.dword, sizeof( color.dword ) );
+    key += text;
+
+    const auto it = cacheIndex.find( key );
+    if( it != cacheIndex.end() )
+    {
+        cache.splice( cache.begin(), cache, it->second );
+        it->second->lastFrame = frame;
+        return it->second->sprite;
+    }
+
+    // compose the whole text into one surface, newlines start a new row of glyphs
+    int nLines = 1;
+    int maxLength = 0;
+    int length = 0;
+    for( auto c : text )
+    {
+        if( c == '\n' )
+        {
+            nLines++;
+            length = 0;
+            continue;
+        }
+        maxLength = std::max( maxLength, ++length );
+    }
+    const Color background = KeyColorFor( color );
+    Surface image = MakeBlank( std::max( maxLength, 1 ) * glyphWidth, nLines * glyphHeight, background );
+    int x = 0;
+    int y = 0;
+    for( auto c : text )
+    {
+        if( c == '\n' )
+        {
+            x = 0;
+            y++;
+            continue;
+        }
+        ComposeGlyph( c, image, glyphWidth * x++, glyphHeight * y, color );
+    }
+
+    // least recently used entries go first, unless they are part of the frame being recorded
+    while( ( int )cache.size() >= cacheSize && cache.back().lastFrame != frame )
+    {
+        cacheIndex.erase( cache.back().key );
+        cache.pop_back();
+    }
+    cache.push_front( { key, RleSprite( image, background ), frame } );
+    cacheIndex[ key ] = cache.begin();
+    return cache.front().sprite;
+}
+
+const RleSprite* Font::GetGlyph( char c, Color color ) const
+{
+    if( c < firstChar + 1 || c > lastChar )
+    {
+        return nullptr;
+    }
+    auto it = glyphs.find( color.dword );
+    if( it == glyphs.end() )
+    {
+        // all glyphs side by side in one surface, one sprite per cell
+        const int nGlyphs = lastChar - firstChar;
+        const Color background = KeyColorFor( color );
+        Surface image = MakeBlank( nGlyphs * glyphWidth, glyphHeight, background );
+        std::vector< RleSprite > sprites;
+        sprites.reserve( nGlyphs );
+        for( int i = 0; i < nGlyphs; i++ )
+        {
+            ComposeGlyph( ( char )( firstChar + 1 + i ), image, i * glyphWidth, 0, color );
+            sprites.emplace_back( image, RectI( { i * glyphWidth, 0 }, glyphWidth, glyphHeight ), background );
+        }
+        it = glyphs.emplace( color.dword, std::move( sprites ) ).first;
+    }
+    return &it->second[ c - firstChar - 1 ];
+}
+
+void Font::ComposeGlyph( char c, Surface& dst, int x, int y, Color color ) const
+{
+    // only characters on the font sheet, ' ' is empty anyway
+    if( c < firstChar + 1 || c > lastChar )
+    {
+        return;
+    }
+    const RectI src = MapGlyphRect( c );
+    const int xStart = std::max( 0, -x );
+    const int yStart = std::max( 0, -y );
+    const int xEnd = std::min( glyphWidth, dst.GetWidth() - x );
+    const int yEnd = std::min( glyphHeight, dst.GetHeight() - y );
+    for( int sy = yStart; sy < yEnd; sy++ )
+    {
+        const Color* pSrc = surface.GetRow( src.top + sy ) + src.left;
+        for( int sx = xStart; sx < xEnd; sx++ )
+        {
+            if( pSrc[ sx ] != chroma )
+            {
+                dst.PutPixel( x + sx, y + sy, color );
+            }
+        }
+    }
+}
+
+void Font::DrawText( const std::string& text, const Vei2& pos, Color color, Surface& dst ) const
+{
     auto curPos = pos;
     for( auto c : text )
     {
-        // on a newline character, reset x position and move down by 1 glyph height
         if( c == '\n' )
         {
-            // carriage return
             curPos.x = pos.x;
-            // line feed
             curPos.y += glyphHeight;
-            // we don't want to advance the character position right for a newline
             continue;
         }
-        // only draw characters that are on the font sheet
-        // start at firstChar + 1 because might as well skip ' ' as well
-        else if( c >= firstChar + 1 && c <= lastChar )
+        ComposeGlyph( c, dst, curPos.x, curPos.y, color );
+        curPos.x += glyphWidth;
+    }
+}
+
+Surface Font::MakeBlank( int width, int height, Color c )
+{
+    Surface s( width, height );
+    for( int y = 0; y < height; y++ )
+    {
+        for( int x = 0; x < width; x++ )
         {
-            // use DrawSpriteSubstitute so that we can choose the color of the font rendered
-            gfx.DrawSprite( curPos.x, curPos.y, MapGlyphRect( c ), surface, e );
+            s.PutPixel( x, y, c );
         }
-        // advance screen pos for next character
-        curPos.x += glyphWidth;
     }
+    return s;
+}
+
+Color Font::KeyColorFor( Color color )
+{
+    return color == Colors::Magenta ? Colors::Black : Colors::Magenta;
 }
 
 RectI Font::MapGlyphRect( char c ) const
@@ -55,7 +176,67 @@ RectI Font::MapGlyphRect( char c ) const
     const int xGlyph = glyphIndex % nColumns;
     // convert the sheet grid coords to pixel coords in sheet
     return RectI(
-    { xGlyph * glyphWidth,yGlyph * glyphHeight },
+    { sheetRect.left + xGlyph * glyphWidth,sheetRect.top + yGlyph * glyphHeight },
         glyphWidth, glyphHeight
     );
-}
\ No newline at end of file
+}
+
+//////////////////////////////////////////////////
+//           Font::TextField
+Font::TextField::TextField( const Font& font, Color color )
+    :
+    pFont( &font ),
+    color( color )
+{
+}
+
+void Font::TextField::SetText( const std::string& newText )
+{
+    if( newText == text )
+    {
+        return;
+    }
+    assert( newText.find( '\n' ) == std::string::npos );
+
+    // only cells with a different character get another glyph
+    if( cells.size() < newText.size() )
+    {
+        cells.resize( newText.size(), nullptr );
+    }
+    const size_t n = std::max( newText.size(), text.size() );
+    for( size_t i = 0; i < n; i++ )
+    {
+        const char oldChar = i < text.size() ? text[ i ] : ' ';
+        const char newChar = i < newText.size() ? newText[ i ] : ' ';
+        if( oldChar != newChar )
+        {
+            cells[ i ] = pFont->GetGlyph( newChar, color );
+        }
+    }
+    text = newText;
+}
+
+void Font::TextField::SetNumber( int value )
+{
+    char buffer[ 16 ];
+    sprintf_s( buffer, "%d", value );
+    SetText( buffer );
+}
+
+void Font::TextField::SetNumber( float value, int decimals )
+{
+    char buffer[ 32 ];
+    sprintf_s( buffer, "%.*f", decimals, value );
+    SetText( buffer );
+}
+
+void Font::TextField::Draw( const Vei2& pos, Graphics& gfx ) const
+{
+    for( size_t i = 0; i < text.size(); i++ )
+    {
+        if( cells[ i ] )
+        {
+            gfx.DrawSprite( pos.x + ( int )i * pFont->glyphWidth, pos.y, *cells[ i ] );
+        }
+    }
+}
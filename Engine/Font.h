@@ -1,18 +1,65 @@
 #pragma once
+#include <list>
+#include <unordered_map>
 #include "Graphics.h"
 #include "Surface.h"
+#include "RleSprite.h"
+#include "SpriteAtlas.h"
 #include "Vei2.h"
 
 class Font
 {
 public:
-    Font( const std::string& filename, Color chroma = Colors::White );
+    /* text which changes often, e.g. numbers in the HUD: every character cell holds a shared glyph sprite of the font,
+       only the cells whose character differs from the previous text get another one. Nothing is composed or encoded
+       after the first use of a colour, and dirty tracking redraws only the changed cells */
+    class TextField
+    {
+    public:
+        TextField( const Font& font, Color color );
+        void SetText( const std::string& text );        /* single line */
+        void SetNumber( int value );
+        void SetNumber( float value, int decimals );
+        void Draw( const Vei2& pos, Graphics& gfx ) const;
+        const std::string& GetText() const
+        {
+            return text;
+        }
+    private:
+        const Font* pFont;
+        Color color;
+        std::string text;
+        std::vector< const RleSprite* > cells;     /* glyph per character (Font::GetGlyph()), null for blanks */
+    };
+public:
+    /* sheet: font sheet bitmap (e.g. a sprite atlas region or a whole surface), has to outlive the font */
+    Font( const SpriteAtlas::Region& sheet, Color chroma = Colors::White, int cacheSize = 256 );
+    /* the rendered text is cached (key: text and colour), drawing it again is a single RLE blit */
     void DrawText( const std::string& text, const Vei2& pos, Color color, Graphics& gfx ) const;
+    /* draws into a surface instead of the screen (composing retained layers), clipped to the surface */
+    void DrawText( const std::string& text, const Vei2& pos, Color color, Surface& dst ) const;
+    int GetGlyphWidth() const
+    {
+        return glyphWidth;
+    }
+    int GetGlyphHeight() const
+    {
+        return glyphHeight;
+    }
 private:
     RectI MapGlyphRect( char c ) const;
+    /* draws glyph c into dst at pixel position x/y, opaque pixels in color (same result as the Substitution effect) */
+    void ComposeGlyph( char c, Surface& dst, int x, int y, Color color ) const;
+    static Color KeyColorFor( Color color );   /* background colour differing from color */
+    static Surface MakeBlank( int width, int height, Color c );
+    const RleSprite& GetCachedText( const std::string& text, Color color, unsigned int frame ) const;
+    /* single glyph in color, null for ' ' and characters not on the sheet. All glyphs of a colour are built on its
+       first use and never evicted */
+    const RleSprite* GetGlyph( char c, Color color ) const;
 private:
-    // holds the font sheet bitmap data
-    Surface surface;
+    // the font sheet bitmap data
+    const Surface& surface;
+    RectI sheetRect;            /* part of surface holding the glyphs */
     // this gives the dimensions of a glyph in the font sheet
     int glyphWidth;
     int glyphHeight;
@@ -24,4 +71,16 @@ private:
     // start and end drawable character codes
     static constexpr char firstChar = ' ';
     static constexpr char lastChar = '~';
+
+    /* text cache, least recently used entries at the back */
+    struct CachedText
+    {
+        std::string key;
+        RleSprite sprite;
+        unsigned int lastFrame;     /* entries used in the current frame are not evicted, the frame is still recorded */
+    };
+    int cacheSize;
+    mutable std::list< CachedText > cache;
+    mutable std::unordered_map< std::string, std::list< CachedText >::iterator > cacheIndex;
+    mutable std::unordered_map< unsigned int, std::vector< RleSprite > > glyphs;   /* colour -> firstChar + 1 .. lastChar */
 };
@@ -21,25 +21,67 @@
 #include "MainWindow.h"
 #include "Game.h"
 
+namespace
+{
+    /* small images drawn every frame, packed into the sprite atlas of the AssetManager */
+    std::vector< std::string > atlasImages()
+    {
+        return {
+            "..\\images\\units\\tank_40x40.bmp",
+            "..\\images\\units\\jet_40x40.bmp",
+            "..\\images\\effects\\expl_1.bmp",
+            "..\\images\\effects\\expl_seq.bmp",
+            "..\\images\\cursor\\cursor.bmp",
+            "..\\images\\cursor\\forbidden.bmp",
+            "..\\images\\cursor\\arrows.bmp",
+            "..\\images\\cursor\\4_arrows.bmp",
+            "..\\images\\actionBar\\factory.bmp",
+            "..\\images\\actionBar\\barracks.bmp",
+            "..\\images\\Fixedsys16x28.bmp"
+        };
+    }
+}
+
 Game::Game( MainWindow& wnd )
 	:
 	wnd( wnd ),
 	gfx( wnd ),
-    m_font( "..\\images\\Fixedsys16x28.bmp" ),
+    m_bandRenderer( gfx, std::min( std::max( ( int )std::thread::hardware_concurrency(), 1 ), 8 ) ),
+    m_assets( atlasImages(), "..\\images\\atlas.txt" ),
+    m_actionBar( m_assets ),
+    m_font( m_assets.getSprite( "..\\images\\Fixedsys16x28.bmp" ) ),
 #if _DEBUG
-    m_level( "..\\images\\debugImg.bmp", m_actionBar.getWidth() ),
+    m_level( m_assets.getSurface( "..\\images\\debugImg.bmp" ), m_actionBar.getWidth() ),
 #else
-    m_level( "..\\images\\maps\\desert.bmp", m_actionBar.getWidth() ),
+    m_level( m_assets.getSurface( "..\\images\\maps\\desert.bmp" ), m_actionBar.getWidth() ),
 #endif
     m_pathFinder( m_level ),
-    m_cursor( gfx, wnd.mouse, m_vpUnits, m_level, m_scrolling_rect, m_actionBar.getWidth() ),
-    m_explSeqSprite( "..\\images\\effects\\expl_seq.bmp" )
+    m_unitGrid( m_level ),
+    m_visibility( m_level ),
+    m_targetScheduler( m_activity, m_unitGrid, m_visibility ),
+    m_minimap( m_level.getImage(), m_actionBar.getMinimapRect() ),
+    m_cursor( gfx, m_assets, wnd.mouse, m_vpUnits, m_level, m_visibility, m_scrolling_rect, m_actionBar.getWidth() ),
+    m_explSeqSprite( m_assets.getSprite( "..\\images\\effects\\expl_seq.bmp" ) )
 {
     srand( ( unsigned int )time( NULL ) );
 
     /* load images */
-    m_vTankSprites = { Surface( "..\\images\\units\\tank_40x40.bmp" ), Surface( "..\\images\\effects\\expl_1.bmp" ), Surface( "..\\images\\effects\\expl_seq.bmp" ) };
-    m_vJetSprites = { Surface( "..\\images\\units\\jet_40x40.bmp" ), Surface( "..\\images\\effects\\expl_1.bmp" ), Surface( "..\\images\\effects\\expl_seq.bmp" ) };
+    m_vTankSprites = { m_assets.getSprite( "..\\images\\units\\tank_40x40.bmp" ), m_assets.getSprite( "..\\images\\effects\\expl_1.bmp" ), m_explSeqSprite };
+    m_vJetSprites = { m_assets.getSprite( "..\\images\\units\\jet_40x40.bmp" ), m_assets.getSprite( "..\\images\\effects\\expl_1.bmp" ), m_explSeqSprite };
+
+    /* tank guns are pre-rendered for every team colour, spawning a tank later does not render anything */
+    for( const Team team : { Team::_A, Team::_B, Team::_C, Team::_D } )
+    {
+        m_spriteCache.getGun( Unit::getGunLength( m_vTankSprites[ ( int )Unit::SpriteOrder::UNIT ].getHeight() ), Unit::getTeamColor( team ) );
+    }
+    /* effect clips, explosions at the zoom levels 1/2 and 1/4 and impacts at 1/2 only, both hidden at the lowest zoom
+       level (units are dots there) */
+    m_explosionClip = m_effects.addClip( m_spriteCache.getPremultiplied( m_explSeqSprite, Colors::White ), 14, 1, 0.07f, 2.0f / 3.0f,
+                                         { nullptr, &m_spriteCache.getRle( m_explSeqSprite, Colors::White, 2, 14 ),
+                                           &m_spriteCache.getRle( m_explSeqSprite, Colors::White, 4, 14 ) } );
+    const SpriteAtlas::Region& impactSprite = m_vTankSprites[ ( int )Unit::SpriteOrder::SHOT ];
+    m_impactClip = m_effects.addClip( m_spriteCache.getPremultiplied( impactSprite, Colors::White ), 1, 1, 0.2f, 0.0f,
+                                      { nullptr, &m_spriteCache.getRle( impactSprite, Colors::White, 2 ) } );
     
     /* load sounds - order important! selection -> command -> attack -> death */
     m_vTankSounds.push_back( Sound( L"..\\sounds\\ready_for_duty.wav" ) );
@@ -71,6 +113,12 @@ void Game::clearMemory()
         delete m_vpUnits[ i ];
     }
     m_vpUnits.clear();
+    m_unitGrid.clear();
+    m_visibility.clear();
+    m_activity.clear();
+    m_targetScheduler.clear();
+    m_combatEvents.clear();
+    m_effects.clear();
 }
 void Game::restartGame()
 {
@@ -81,25 +129,38 @@ void Game::restartGame()
     clearMemory();
 
     /* create units */
-    m_vpUnits.push_back( new Unit( { 3, 5 }, Team::_A, m_level, m_pathFinder, m_vpUnits, UnitType::TANK, m_vTankSprites, m_vTankSounds ) );
-    m_vpUnits.push_back( new Unit( { 2, 3 }, Team::_A, m_level, m_pathFinder, m_vpUnits, UnitType::TANK, m_vTankSprites, m_vTankSounds ) );
-    m_vpUnits.push_back( new Unit( { 14, 3 }, Team::_A, m_level, m_pathFinder, m_vpUnits, UnitType::TANK, m_vTankSprites, m_vTankSounds ) );
-    m_vpUnits.push_back( new Unit( { 39, 3 }, Team::_A, m_level, m_pathFinder, m_vpUnits, UnitType::TANK, m_vTankSprites, m_vTankSounds ) );
-    m_vpUnits.push_back( new Unit( { 34, 7 }, Team::_A, m_level, m_pathFinder, m_vpUnits, UnitType::TANK, m_vTankSprites, m_vTankSounds ) );
-    m_vpUnits.push_back( new Unit( { 7, 2 }, Team::_A, m_level, m_pathFinder, m_vpUnits, UnitType::JET, m_vJetSprites, m_vJetSounds ) );
-    m_vpUnits.push_back( new Unit( { 10, 4 }, Team::_A, m_level, m_pathFinder, m_vpUnits, UnitType::JET, m_vJetSprites, m_vJetSounds ) );
+    spawnUnit( { 3, 5 }, Team::_A, UnitType::TANK );
+    spawnUnit( { 2, 3 }, Team::_A, UnitType::TANK );
+    spawnUnit( { 14, 3 }, Team::_A, UnitType::TANK );
+    spawnUnit( { 39, 3 }, Team::_A, UnitType::TANK );
+    spawnUnit( { 34, 7 }, Team::_A, UnitType::TANK );
+    spawnUnit( { 7, 2 }, Team::_A, UnitType::JET );
+    spawnUnit( { 10, 4 }, Team::_A, UnitType::JET );
 
     /* create enemies */
-    m_vpUnits.push_back( new Unit( { 7, 12 }, Team::_B, m_level, m_pathFinder, m_vpUnits, UnitType::TANK, m_vTankSprites, m_vTankSounds ) );
-    m_vpUnits.push_back( new Unit( { 17, 13 }, Team::_B, m_level, m_pathFinder, m_vpUnits, UnitType::JET, m_vJetSprites, m_vJetSounds ) );
-    m_vpUnits.push_back( new Unit( { 13, 13 }, Team::_B, m_level, m_pathFinder, m_vpUnits, UnitType::JET, m_vJetSprites, m_vJetSounds ) );
-    m_vpUnits.push_back( new Unit( { 27, 17 }, Team::_B, m_level, m_pathFinder, m_vpUnits, UnitType::TANK, m_vTankSprites, m_vTankSounds ) );
-    m_vpUnits.push_back( new Unit( { 33, 15 }, Team::_B, m_level, m_pathFinder, m_vpUnits, UnitType::JET, m_vJetSprites, m_vJetSounds ) );
-    m_vpUnits.push_back( new Unit( { 31, 13 }, Team::_B, m_level, m_pathFinder, m_vpUnits, UnitType::JET, m_vJetSprites, m_vJetSounds ) );
+    spawnUnit( { 7, 12 }, Team::_B, UnitType::TANK );
+    spawnUnit( { 17, 13 }, Team::_B, UnitType::JET );
+    spawnUnit( { 13, 13 }, Team::_B, UnitType::JET );
+    spawnUnit( { 27, 17 }, Team::_B, UnitType::TANK );
+    spawnUnit( { 33, 15 }, Team::_B, UnitType::JET );
+    spawnUnit( { 31, 13 }, Team::_B, UnitType::JET );
 
     /* reset camera position */
+    m_level.setZoom( 0 );
     m_camPos = Vei2( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
 }
+void Game::spawnUnit( const Vei2 pos_tile, const Team team, const UnitType type )
+{
+    if( UnitType::JET == type )
+    {
+        m_vpUnits.push_back( new Unit( pos_tile, team, m_level, m_pathFinder, m_vpUnits, m_combatEvents, type, m_vJetSprites, m_spriteCache, m_vJetSounds ) );
+    }
+    else
+    {
+        m_vpUnits.push_back( new Unit( pos_tile, team, m_level, m_pathFinder, m_vpUnits, m_combatEvents, type, m_vTankSprites, m_spriteCache, m_vTankSounds ) );
+    }
+    m_activity.add( m_vpUnits.back() );
+}
 void Game::updateCamera( const float dt )
 {
     if( m_bSelecting )
@@ -108,19 +169,20 @@ void Game::updateCamera( const float dt )
     }
 
     Vec2 mp = wnd.mouse.GetPos();
+    const int scale = m_level.getZoomScale();   /* same speed on the screen at every zoom level */
     
     if( m_bScrollingPressed )
     {
         Vec2 d = m_scrollingStartPos - mp;
 
-        m_camPos.x += ( int )d.x;
-        m_camPos.y += ( int )d.y;
+        m_camPos.x += ( int )d.x * scale;
+        m_camPos.y += ( int )d.y * scale;
 
         m_scrollingStartPos = mp;
     }
     else if( wnd.mouse.IsInWindow() )
     {
-        const int pixelsToMove = int( 500.0f * dt );
+        const int pixelsToMove = int( 500.0f * dt ) * scale;
         if( mp.x < m_scrolling_rect.left )
         {
             m_camPos.x -= pixelsToMove;
@@ -139,10 +201,27 @@ void Game::updateCamera( const float dt )
         }
     }
 
-    m_camPos.x = std::max( Graphics::halfScreenWidth, m_camPos.x );
-    m_camPos.x = std::min( m_level.getWidth() - Graphics::halfScreenWidth + m_actionBar.getWidth(), m_camPos.x );
-    m_camPos.y = std::max( Graphics::halfScreenHeight, m_camPos.y );
-    m_camPos.y = std::min( m_level.getHeight() - Graphics::halfScreenHeight, m_camPos.y );
+    clampCamera();
+}
+void Game::centerCamera( const Vei2& levelPos )
+{
+    m_camPos = levelPos + Vei2( m_actionBar.getWidth() / 2 * m_level.getZoomScale(), 0 );
+    clampCamera();
+}
+void Game::clampCamera()
+{
+    m_camPos = m_level.clampCamera( m_camPos );
+}
+void Game::setZoom( const int zoom )
+{
+    if( zoom < 0 || zoom >= Level::nZoomLevels || zoom == m_level.getZoom() || ( zoom > 0 && m_actionBar.isPlacing() ) )
+    {
+        return;
+    }
+    const Vei2 center = m_camPos - Vei2( m_actionBar.getWidth() / 2 * m_level.getZoomScale(), 0 );
+    m_level.setZoom( zoom );
+    centerCamera( center );
+    m_bandRenderer.invalidate();
 }
 void Game::updateKeyboard( const float dt )
 {
@@ -172,6 +251,36 @@ void Game::updateKeyboard( const float dt )
             {
                 m_bDrawLifeBars = !m_bDrawLifeBars;
             }
+            else if( e.GetCode() == 'T' )
+            {
+                /* 1, 2, 4, ... threads up to the number of cores */
+                const int maxThreads = std::max( ( int )std::thread::hardware_concurrency(), 1 );
+                const int nThreads = m_bandRenderer.getNumThreads() * 2;
+                m_bandRenderer.setNumThreads( nThreads > maxThreads ? 1 : nThreads );
+            }
+            else if( e.GetCode() == 'R' )
+            {
+                m_bandRenderer.setDirtyTracking( !m_bandRenderer.isDirtyTracking() );
+            }
+            else if( e.GetCode() == 'B' )
+            {
+                m_vBenchmarkResults = BlitBenchmark::run( gfx, m_assets.getSurface( "..\\images\\units\\tank_40x40.bmp" ), m_level.getImage() );
+                m_bandRenderer.invalidate();
+                m_bDrawDebugStuff = true;
+            }
+            else if( e.GetCode() == VK_ADD || e.GetCode() == VK_PRIOR )
+            {
+                setZoom( m_level.getZoom() - 1 );
+            }
+            else if( e.GetCode() == VK_SUBTRACT || e.GetCode() == VK_NEXT )
+            {
+                setZoom( m_level.getZoom() + 1 );
+            }
+            else if( e.GetCode() == 'I' )
+            {
+                m_vBenchmarkResults = LoadBenchmark::run( "..\\images" );
+                m_bDrawDebugStuff = true;
+            }
         }
     }
 
@@ -182,7 +291,7 @@ void Game::updateKeyboard( const float dt )
         return;     /* not allowing to scroll while selecting units with rectangle */
     }
 
-    const int pixelsToMove = int( 500.0f * dt );
+    const int pixelsToMove = int( 500.0f * dt ) * m_level.getZoomScale();
     if( wnd.kbd.KeyIsPressed( VK_RIGHT ) || wnd.kbd.KeyIsPressed( 'D' ) )
     {
         m_camPos.x += pixelsToMove;
@@ -220,9 +329,27 @@ void Game::deselectAllUnits()
 }
 void Game::Go()
 {
-	gfx.BeginFrame();	
 	UpdateModel();
-	ComposeFrame();
+
+    /* level and action bar overwrite every pixel, so the clear can be skipped. With dirty tracking the last frame is reused */
+    m_bandRenderer.setCamera( m_level.getViewOffset( m_camPos ) / m_level.getZoomScale() );
+	gfx.BeginFrame( !m_level.coversScreen() && !m_bandRenderer.keepsFrame() );
+
+    const auto composeStart = std::chrono::steady_clock::now();
+    if( m_bandRenderer.needsRecording() )
+    {
+        /* draw calls are recorded and then rasterised band by band in parallel, only where something changed */
+        gfx.BeginRecording( m_bandRenderer );
+        ComposeFrame();
+        gfx.EndRecording();
+        m_bandRenderer.render();
+    }
+    else
+    {
+        ComposeFrame();
+    }
+    m_composeTime = std::chrono::duration< float, std::milli >( std::chrono::steady_clock::now() - composeStart ).count();
+
 	gfx.EndFrame();
 }
 
@@ -240,27 +367,19 @@ void Game::UpdateModel()
     ///////////////
     //// UNITS ////
     ///////////////
-    for( auto &u : m_vpUnits )
-    {
-        u->update( dt );
-    }
+    /* dormant units are skipped, they are woken up by damage, commands or enemies nearby.
+       Units outside the view are updated at a reduced rate */
+    m_simulationLod.update( m_activity.getActiveUnits(), m_level.getViewRect( m_camPos ), dt );
+    m_combatEvents.resolve( m_activity, m_effects, m_impactClip );
+    m_unitGrid.update( m_activity.getActiveUnits() );    /* dormant units do not move */
+    m_visibility.update( m_activity.getActiveUnits() );
+    m_minimap.update( m_vpUnits, m_visibility );
+    m_targetScheduler.update( dt );
 
-    ///////////////////
-    //// SEQUENCES ////
-    ///////////////////
-    auto s = m_vpDeathSequences.begin();
-    while( s != m_vpDeathSequences.end() )
-    {
-        if( ( *s )->update( dt ) )
-        {
-            delete ( *s );
-            s = m_vpDeathSequences.erase( s );
-        }
-        else
-        {
-            s++;
-        }
-    }
+    /////////////////
+    //// EFFECTS ////
+    /////////////////
+    m_effects.update( dt );
 
     //////////////////
     //// KEYBOARD ////
@@ -276,6 +395,10 @@ void Game::UpdateModel()
     //// ACTION BAR ////
     ////////////////////
     m_actionBar.update( dt, wnd.mouse.GetPos(), m_camPos, m_level );
+    if( m_actionBar.isPlacing() && m_level.getZoom() > 0 )
+    {
+        setZoom( 0 );   /* buildings are placed at 1:1 */
+    }
 
     ////////////////
     //// CAMERA ////
@@ -283,56 +406,57 @@ void Game::UpdateModel()
     updateCamera( dt );
 }
 
-void Game::drawAllUnits()
+void Game::fillRenderQueue()
 {
-#if _DEBUG
-    const Vei2 halfScreen( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
-    const Vei2 offset = m_camPos - halfScreen;
-#endif
-    /* draw all ground units first */
-    for( int i = 0; i < m_vpUnits.size(); ++i )
+    /* the action bar is opaque */
+    m_renderQueue.begin( m_level.getViewRect( m_camPos ), m_level.getViewOffset( m_camPos ), m_bDrawDebugStuff, m_level.getZoom() );
+
+    /* layers: ground units, their life bars, air units, their life bars, effects, cursor */
+    for( const auto u : m_vpUnits )
     {
-        if( m_vpUnits[ i ]->isGroundUnit() )
-        {
-            m_vpUnits[ i ]->draw( gfx, { m_camPos.x, m_camPos.y }, m_bDrawDebugStuff );
-#if _DEBUG
-            m_font.DrawText( std::to_string( i ), m_vpUnits[ i ]->getLocationInt() - Vei2( 30, 10 ) - offset, Colors::Red, gfx );
-#endif
-        }
+        m_renderQueue.addUnit( u, m_bDrawLifeBars );
     }
-    /* draw life bars on top */
-    if( m_bDrawLifeBars )
+    m_renderQueue.addEffects( m_effects );
+    m_renderQueue.addCursor( &m_cursor, m_bScrollingPressed, m_bSelecting );
+    m_renderQueue.sort();
+}
+
+void Game::drawPerfStats()
+{
+    std::vector< std::string > vLines;
+    vLines.push_back( "units: " + std::to_string( m_vpUnits.size() ) + " (active " + std::to_string( m_activity.getNumActive() )
+                      + ", dormant " + std::to_string( m_activity.getNumDormant() ) + ")" );
+    vLines.push_back( "reduced lod: " + std::to_string( m_simulationLod.getNumReduced() ) );
+    vLines.push_back( "drawn: " + std::to_string( m_renderQueue.getNumQueued() ) + ", culled " + std::to_string( m_renderQueue.getNumCulled() ) );
+    vLines.push_back( "scans: " + std::to_string( m_targetScheduler.getScansLastFrame() ) );
+    vLines.push_back( "dmg events: " + std::to_string( m_combatEvents.getEventsLastTick() ) );
+    vLines.push_back( "minimap cells changed: " + std::to_string( m_minimap.getChangedCellsLastFrame() ) );
+    vLines.push_back( "zoom: 1/" + std::to_string( m_level.getZoomScale() ) );
+    char buffer[ 64 ];
+    sprintf_s( buffer, "render threads: %d, compose %.2f ms", m_bandRenderer.getNumThreads(), m_composeTime );
+    vLines.push_back( buffer );
+    if( m_bandRenderer.isDirtyTracking() )
     {
-        for( int i = 0; i < m_vpUnits.size(); ++i )
-        {
-            if( m_vpUnits[ i ]->isGroundUnit() )
-            {
-                m_vpUnits[ i ]->drawLifeBar( gfx, m_camPos );
-            }
-        }
+        sprintf_s( buffer, "redrawn: %.1f%% of the screen", m_bandRenderer.getDirtyFraction() * 100.0f );
+        vLines.push_back( buffer );
     }
-
-    /* draw all air units */
-    for( int i = 0; i < m_vpUnits.size(); ++i )
+    sprintf_s( buffer, "assets: %d files read, %.1f MB, atlas %d pages%s", m_assets.getNumFilesRead(), m_assets.getMemoryUsage() / ( 1024.0f * 1024.0f ),
+               m_assets.getAtlas().getNumPages(), m_assets.isAtlasCached() ? " (cached)" : "" );
+    vLines.push_back( buffer );
+    vLines.insert( vLines.end(), m_vBenchmarkResults.begin(), m_vBenchmarkResults.end() );
+
+    /* bottom left corner, last line at the bottom. The lines change every frame, so every line keeps its own
+       text field and only the changed glyphs are drawn again */
+    while( m_vPerfStatFields.size() < vLines.size() )
     {
-        if( !m_vpUnits[ i ]->isGroundUnit() )
-        {
-            m_vpUnits[ i ]->draw( gfx, m_camPos, m_bDrawDebugStuff );
-#if _DEBUG
-            m_font.DrawText( std::to_string( i ), m_vpUnits[ i ]->getLocationInt() - Vei2( 30, 10 ) - offset, Colors::Red, gfx );
-#endif
-        }
+        m_vPerfStatFields.emplace_back( m_font, Colors::Cyan );
     }
-    /* draw life bars on top */
-    if( m_bDrawLifeBars )
+    int y = Graphics::ScreenHeight - 30 * ( int )vLines.size();
+    for( int i = 0; i < vLines.size(); ++i )
     {
-        for( int i = 0; i < m_vpUnits.size(); ++i )
-        {
-            if( !m_vpUnits[ i ]->isGroundUnit() )
-            {
-                m_vpUnits[ i ]->drawLifeBar( gfx, m_camPos );
-            }
-        }
+        m_vPerfStatFields[ i ].SetText( vLines[ i ] );
+        m_vPerfStatFields[ i ].Draw( { 5, y }, gfx );
+        y += 30;
     }
 }
 
@@ -349,12 +473,16 @@ void Game::checkForDestroyedUnits()
                 m_vpUnits[ i ]->checkDestroyedEnemy( *u );
             }
 
-            // add death sequence
+            // add death explosion
             if( ( *u )->getType() == UnitType::TANK || ( *u )->getType() == UnitType::JET )
             {
-                m_vpDeathSequences.push_back( new SurfaceSequence( m_explSeqSprite, 14, 1, ( *u )->getLocationInt(), 0.07f ) );
+                m_effects.spawn( m_explosionClip, ( *u )->getLocationInt() );
             }
 
+            m_unitGrid.remove( *u );
+            m_visibility.remove( *u );
+            m_activity.remove( *u );
+            m_targetScheduler.remove( *u );
             delete (*u);
             u = m_vpUnits.erase( u );
         }
@@ -375,9 +503,6 @@ void Game::handleMouse()
             bMouseOverActionBar = true;
         }
 
-        const Vei2 halfScreen( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
-        const Vei2 offset = m_camPos - halfScreen;
-
         while( !wnd.mouse.IsEmpty() )
         {
             const Mouse::Event e = wnd.mouse.Read();
@@ -385,12 +510,32 @@ void Game::handleMouse()
             /* action bar */
             m_actionBar.handleMouse( e.GetType(), wnd.mouse.GetPos() );
 
+            /* minimap: the view follows the mouse while the left button is down */
+            const Vei2 mousePos( wnd.mouse.GetPosX(), wnd.mouse.GetPosY() );
+            if( e.LeftIsPressed() && !m_bSelecting && m_minimap.contains( mousePos ) )
+            {
+                centerCamera( m_minimap.toLevel( mousePos ) );
+            }
+
+            /* zoom */
+            if( !bMouseOverActionBar && e.GetType() == Mouse::Event::Type::WheelUp )
+            {
+                setZoom( m_level.getZoom() - 1 );
+            }
+            else if( !bMouseOverActionBar && e.GetType() == Mouse::Event::Type::WheelDown )
+            {
+                setZoom( m_level.getZoom() + 1 );
+            }
+
             /* units */
             if( !bMouseOverActionBar )
             {
                 for( auto &u : m_vpUnits )
                 {
-                    u->handleMouse( e.GetType(), wnd.mouse.GetPos(), m_camPos, wnd.kbd.KeyIsPressed( VK_SHIFT ) );
+                    if( u->handleMouse( e.GetType(), wnd.mouse.GetPos(), m_camPos, wnd.kbd.KeyIsPressed( VK_SHIFT ) ) )
+                    {
+                        m_activity.wake( u );
+                    }
                 }
             }
 
@@ -422,7 +567,7 @@ void Game::handleMouse()
 
                 for( auto &u : m_vpUnits )
                 {
-                    u->handleSelectionRect( m_selection, offset );
+                    u->handleSelectionRect( m_selection, m_camPos );
                 }
             }
             if( e.GetType() == Mouse::Event::Type::LRelease && m_bSelecting )
@@ -434,7 +579,7 @@ void Game::handleMouse()
                     {
                         continue;
                     }
-                    if( m_selection.Contains( u->getLocation() - offset ) )
+                    if( m_selection.Contains( m_level.worldToScreen( u->getLocation(), m_camPos ) ) )
                     {
                         u->select();
                     }
@@ -467,17 +612,26 @@ void Game::handleMouse()
 
 void Game::ComposeFrame()
 {
+    /* everything up to the effects moves with the camera */
+    m_bandRenderer.beginWorld( m_level.getViewOffset( m_camPos ) / m_level.getZoomScale() );
+
     /* LEVEL */
     m_level.draw( gfx, m_camPos, m_bDrawDebugStuff );
     
-    /* UNITS */
-    drawAllUnits();
-
-    /* DEATH SEQs */
-    for( const auto s : m_vpDeathSequences )
+    /* UNITS & EFFECTS */
+    fillRenderQueue();
+    m_renderQueue.draw( gfx, RenderQueue::Layer::GROUND, RenderQueue::Layer::EFFECTS );
+#if _DEBUG  /* unit indices (1:1 only) */
+    const Vei2 offset = m_camPos - Vei2( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
+    for( int i = 0; i < m_vpUnits.size() && m_level.getZoom() == 0; ++i )
     {
-        s->Draw( gfx, m_camPos );
+        if( m_vpUnits[ i ]->getDrawBounds().IsOverlappingWith( RectI( offset, Graphics::ScreenWidth, Graphics::ScreenHeight ) ) )
+        {
+            m_font.DrawText( std::to_string( i ), m_vpUnits[ i ]->getLocationInt() - Vei2( 30, 10 ) - offset, Colors::Red, gfx );
+        }
     }
+#endif
+    m_bandRenderer.endWorld();
 
     /* SELECTING RECT */
     if( m_bSelecting )
@@ -488,14 +642,17 @@ void Game::ComposeFrame()
     /* DEBUG STUFF */
 #if _DEBUG  /* display additional unit infos */
     int x = 50;
-    char text[ 50 ];
     int numberUnitInfos = std::min( 5, ( int )m_vpUnits.size() );
+    while( m_vUnitInfoFields.size() < 2 * numberUnitInfos )    /* velocity and waiting time per unit */
+    {
+        m_vUnitInfoFields.emplace_back( m_font, Colors::Cyan );
+    }
     for( int i = 0; i < numberUnitInfos; ++i )
     {
         m_font.DrawText( std::to_string( i ), { x, 1 }, Colors::Cyan, gfx );
 
-        sprintf_s( text, "%0.3f", m_vpUnits[ i ]->getVelocity().GetLength() );
-        m_font.DrawText( text, { x, 30 }, Colors::Cyan, gfx );
+        m_vUnitInfoFields[ 2 * i ].SetNumber( m_vpUnits[ i ]->getVelocity().GetLength(), 3 );
+        m_vUnitInfoFields[ 2 * i ].Draw( { x, 30 }, gfx );
         if( m_vpUnits[ i ]->getState() == Unit::State::MOVING )
         {
             m_font.DrawText( "Moving", { x, 60 }, Colors::Cyan, gfx );
@@ -512,22 +669,24 @@ void Game::ComposeFrame()
         {
             m_font.DrawText( "Attacking", { x, 60 }, Colors::Cyan, gfx );
         }
-        sprintf_s( text, "%0.3f", m_vpUnits[ i ]->getWaitingTime() );
-        m_font.DrawText( text, { x, 90 }, Colors::Cyan, gfx );
+        m_vUnitInfoFields[ 2 * i + 1 ].SetNumber( m_vpUnits[ i ]->getWaitingTime(), 3 );
+        m_vUnitInfoFields[ 2 * i + 1 ].Draw( { x, 90 }, gfx );
 
         x += 150;
     }
 #endif
 
-    /* ACTION BAR */
+    /* ACTION BAR & MINIMAP */
     m_actionBar.draw( gfx, m_font, wnd.mouse.GetPos() );
+    m_minimap.draw( gfx, m_level.getViewRect( m_camPos ) );
 
-    /* SCROLLING RECT */
+    /* SCROLLING RECT & PERF STATS */
     if( m_bDrawDebugStuff )
     {
         gfx.DrawRectBorder( m_scrolling_rect, 1, Colors::Magenta );
+        drawPerfStats();
     }
 
     /* CURSOR */
-    m_cursor.draw( m_camPos, m_bScrollingPressed, m_bSelecting );
+    m_renderQueue.draw( gfx, RenderQueue::Layer::CURSOR, RenderQueue::Layer::CURSOR );
 }
@@ -25,6 +25,7 @@
 #include "Graphics.h"
 #include "Sound.h"
 #include "Surface.h"
+#include "AssetManager.h"
 #include "FrameTimer.h"
 #include "Level.h"
 #include "Unit.h"
@@ -32,8 +33,19 @@
 #include "Font.h"
 #include "Defines.h"
 #include "Cursor.h"
-#include "SurfaceSequence.h"
+#include "EffectPool.h"
 #include "ActionBar.h"
+#include "UnitGrid.h"
+#include "TargetScheduler.h"
+#include "CombatEvents.h"
+#include "UnitActivity.h"
+#include "SimulationLod.h"
+#include "VisibilityGrid.h"
+#include "BlitBenchmark.h"
+#include "LoadBenchmark.h"
+#include "BandRenderer.h"
+#include "RenderQueue.h"
+#include "Minimap.h"
 
 class Game
 {
@@ -48,33 +60,50 @@ private:
 	void UpdateModel();
 	/********************************/
 	/*  User Functions              */
-    void drawAllUnits();
+    void fillRenderQueue();     /* visible units, effects and the cursor of this frame */
     void checkForDestroyedUnits();
     void handleMouse();
     void clearMemory();
     void restartGame();
+    void spawnUnit( const Vei2 pos_tile, const Team team, const UnitType type );
     void updateCamera( const float dt );
+    void centerCamera( const Vei2& levelPos );     /* middle of the view (left of the action bar) on levelPos */
+    void clampCamera();
+    void setZoom( const int zoom );     /* Level zoom level, keeps the middle of the view. Building placement is 1:1 only */
     void updateKeyboard( const float dt );
     bool unitSelected();    /* checks if at least one unit is selected (no right-button-mouse-scrolling then) */
     void deselectAllUnits();
+    void drawPerfStats();
 	/********************************/
 private:
 	MainWindow& wnd;
 	Graphics gfx;
 	/********************************/
 	/*  User Variables              */
+    BandRenderer m_bandRenderer;            /* parallel ComposeFrame (key 'T' changes the number of threads), dirty regions only (key 'R', off by default) */
+    float m_composeTime = 0.0f;             /* in milliseconds, last frame */
+    RenderQueue m_renderQueue;              /* draw list of the current frame */
+    AssetManager m_assets;                  /* every image file is loaded once and shared */
     ActionBar m_actionBar;
     FrameTimer ft;
     Font m_font;
     Level m_level;
     PathFinder m_pathFinder;
+    UnitGrid m_unitGrid;
+    VisibilityGrid m_visibility;            /* per team visible tiles */
+    UnitActivity m_activity;                /* active / dormant units */
+    SimulationLod m_simulationLod;          /* reduced update rate for off-screen units */
+    TargetScheduler m_targetScheduler;      /* enemy scans of idle units */
+    CombatEventQueue m_combatEvents;        /* damage of all shots fired during one tick */
+    Minimap m_minimap;                      /* bottom of the action bar, a click moves the camera */
 
     RectI m_selection;
     bool m_bSelecting = false;
 
-    std::vector< Surface > m_vTankSprites;
-    std::vector< Surface > m_vJetSprites;
-    std::vector< Surface > m_vSoldierSprites;
+    std::vector< SpriteAtlas::Region > m_vTankSprites;  /* regions of the sprite atlas in m_assets */
+    std::vector< SpriteAtlas::Region > m_vJetSprites;
+    std::vector< SpriteAtlas::Region > m_vSoldierSprites;
+    SpriteCache m_spriteCache;              /* team colour / damage variants of the unit sprites */
     std::vector< Sound > m_vTankSounds;
     std::vector< Sound > m_vJetSounds;
     std::vector< Sound > m_vSoldierSounds;
@@ -82,11 +111,16 @@ private:
     
     Sound m_backGroundSound;
 
-    Surface m_explSeqSprite;
-    std::vector< SurfaceSequence* > m_vpDeathSequences;
+    SpriteAtlas::Region m_explSeqSprite;
+    EffectPool m_effects;                   /* running explosions and impacts */
+    int m_explosionClip;                    /* clip ids of m_effects */
+    int m_impactClip;
 
     bool m_bDrawLifeBars = true;
     bool m_bDrawDebugStuff = false;
+    std::vector< std::string > m_vBenchmarkResults;    /* last BlitBenchmark (key 'B') or LoadBenchmark (key 'I') run, shown with the debug stuff */
+    std::vector< Font::TextField > m_vPerfStatFields;  /* one per line of drawPerfStats() */
+    std::vector< Font::TextField > m_vUnitInfoFields;  /* numbers of the _DEBUG unit infos */
     
     /* Scrolling */
     Vei2 m_camPos = Vei2( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
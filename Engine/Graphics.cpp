@@ -18,302 +18,299 @@
 *	You should have received a copy of the GNU General Public License					  *
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
-#include "MainWindow.h"
 #include "Graphics.h"
-#include "DXErr.h"
-#include "ChiliException.h"
+#include "BandRenderer.h"
+#include "Raster.h"
 #include <assert.h>
 #include <string>
 #include <array>
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
 
-// Ignore the intellisense error "cannot open source file" for .shh files.
-// They will be created during the build sequence before the preprocessor runs.
-namespace FramebufferShaders
+Graphics::Graphics( std::unique_ptr< Presenter > presenter )
+	:
+	pPresenter( std::move( presenter ) )
 {
-#include "FramebufferPS.shh"
-#include "FramebufferVS.shh"
+	assert( pPresenter );
+	// allocate memory for sysbuffer (16-byte aligned for faster access)
+#ifdef _MSC_VER
+	pSysBuffer = reinterpret_cast<Color*>( 
+		_aligned_malloc( sizeof( Color ) * Graphics::ScreenWidth * Graphics::ScreenHeight,16u ) );
+#else
+	pSysBuffer = reinterpret_cast<Color*>(
+		aligned_alloc( 16u,sizeof( Color ) * Graphics::ScreenWidth * Graphics::ScreenHeight ) );
+#endif
 }
 
-#pragma comment( lib,"d3d11.lib" )
-
-#define CHILI_GFX_EXCEPTION( hr,note ) Graphics::Exception( hr,note,_CRT_WIDE(__FILE__),__LINE__ )
-
-using Microsoft::WRL::ComPtr;
-
-Graphics::Graphics( HWNDKey& key )
+Graphics::~Graphics()
 {
-	assert( key.hWnd != nullptr );
-
-	//////////////////////////////////////////////////////
-	// create device and swap chain/get render target view
-	DXGI_SWAP_CHAIN_DESC sd = {};
-	sd.BufferCount = 1;
-	sd.BufferDesc.Width = Graphics::ScreenWidth;
-	sd.BufferDesc.Height = Graphics::ScreenHeight;
-	sd.BufferDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-	sd.BufferDesc.RefreshRate.Numerator = 1;
-	sd.BufferDesc.RefreshRate.Denominator = 60;
-	sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	sd.OutputWindow = key.hWnd;
-	sd.SampleDesc.Count = 1;
-	sd.SampleDesc.Quality = 0;
-	sd.Windowed = TRUE;
-
-	HRESULT				hr;
-	UINT				createFlags = 0u;
-#ifdef CHILI_USE_D3D_DEBUG_LAYER
-#ifdef _DEBUG
-	createFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-#endif
-	
-	// create device and front/back buffers
-	if( FAILED( hr = D3D11CreateDeviceAndSwapChain( 
-		nullptr,
-		D3D_DRIVER_TYPE_HARDWARE,
-		nullptr,
-		createFlags,
-		nullptr,
-		0,
-		D3D11_SDK_VERSION,
-		&sd,
-		&pSwapChain,
-		&pDevice,
-		nullptr,
-		&pImmediateContext ) ) )
+	// free sysbuffer memory (aligned free)
+	if( pSysBuffer )
 	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating device and swap chain" );
+#ifdef _MSC_VER
+		_aligned_free( pSysBuffer );
+#else
+		free( pSysBuffer );
+#endif
+		pSysBuffer = nullptr;
 	}
+}
 
-	// get handle to backbuffer
-	ComPtr<ID3D11Resource> pBackBuffer;
-	if( FAILED( hr = pSwapChain->GetBuffer(
-		0,
-		__uuidof( ID3D11Texture2D ),
-		(LPVOID*)&pBackBuffer ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Getting back buffer" );
-	}
+RectI Graphics::GetScreenRect()
+{
+	return{ 0,ScreenWidth,0,ScreenHeight };
+}
 
-	// create a view on backbuffer that we can render to
-	if( FAILED( hr = pDevice->CreateRenderTargetView( 
-		pBackBuffer.Get(),
-		nullptr,
-		&pRenderTargetView ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating render target view on backbuffer" );
-	}
+thread_local RectI Graphics::clipRect = Graphics::GetScreenRect();
 
+void Graphics::SetClipRect( const RectI& clip )
+{
+    assert( clip.IsContainedBy( GetScreenRect() ) );
+    clipRect = clip;
+}
 
-	// set backbuffer as the render target using created view
-	pImmediateContext->OMSetRenderTargets( 1,pRenderTargetView.GetAddressOf(),nullptr );
-
-
-	// set viewport dimensions
-	D3D11_VIEWPORT vp;
-	vp.Width = float( Graphics::ScreenWidth );
-	vp.Height = float( Graphics::ScreenHeight );
-	vp.MinDepth = 0.0f;
-	vp.MaxDepth = 1.0f;
-	vp.TopLeftX = 0.0f;
-	vp.TopLeftY = 0.0f;
-	pImmediateContext->RSSetViewports( 1,&vp );
-
-
-	///////////////////////////////////////
-	// create texture for cpu render target
-	D3D11_TEXTURE2D_DESC sysTexDesc;
-	sysTexDesc.Width = Graphics::ScreenWidth;
-	sysTexDesc.Height = Graphics::ScreenHeight;
-	sysTexDesc.MipLevels = 1;
-	sysTexDesc.ArraySize = 1;
-	sysTexDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-	sysTexDesc.SampleDesc.Count = 1;
-	sysTexDesc.SampleDesc.Quality = 0;
-	sysTexDesc.Usage = D3D11_USAGE_DYNAMIC;
-	sysTexDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-	sysTexDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	sysTexDesc.MiscFlags = 0;
-	// create the texture
-	if( FAILED( hr = pDevice->CreateTexture2D( &sysTexDesc,nullptr,&pSysBufferTexture ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating sysbuffer texture" );
-	}
+RectI Graphics::GetClipRect()
+{
+    return clipRect;
+}
 
-	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Format = sysTexDesc.Format;
-	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MipLevels = 1;
-	// create the resource view on the texture
-	if( FAILED( hr = pDevice->CreateShaderResourceView( pSysBufferTexture.Get(),
-		&srvDesc,&pSysBufferTextureView ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating view on sysBuffer texture" );
-	}
+void Graphics::BeginRecording( BandRenderer& renderer )
+{
+    assert( !pRecorder );
+    pRecorder = &renderer;
+}
 
+void Graphics::EndRecording()
+{
+    pRecorder = nullptr;
+}
 
-	////////////////////////////////////////////////
-	// create pixel shader for framebuffer
-	// Ignore the intellisense error "namespace has no member"
-	if( FAILED( hr = pDevice->CreatePixelShader(
-		FramebufferShaders::FramebufferPSBytecode,
-		sizeof( FramebufferShaders::FramebufferPSBytecode ),
-		nullptr,
-		&pPixelShader ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating pixel shader" );
-	}
-	
-
-	/////////////////////////////////////////////////
-	// create vertex shader for framebuffer
-	// Ignore the intellisense error "namespace has no member"
-	if( FAILED( hr = pDevice->CreateVertexShader(
-		FramebufferShaders::FramebufferVSBytecode,
-		sizeof( FramebufferShaders::FramebufferVSBytecode ),
-		nullptr,
-		&pVertexShader ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating vertex shader" );
-	}
-	
+void Graphics::Record( const DrawKey& key, const RectI& bounds, std::function< void( Graphics& ) > command )
+{
+    const RectI screen = GetScreenRect();
+    const RectI clipped( std::max( bounds.left, screen.left ), std::min( bounds.right, screen.right ),
+                         std::max( bounds.top, screen.top ), std::min( bounds.bottom, screen.bottom ) );
+    pRecorder->record( key, clipped, std::move( command ) );
+}
 
-	//////////////////////////////////////////////////////////////
-	// create and fill vertex buffer with quad for rendering frame
-	const FSQVertex vertices[] =
-	{
-		{ -1.0f,1.0f,0.5f,0.0f,0.0f },
-		{ 1.0f,1.0f,0.5f,1.0f,0.0f },
-		{ 1.0f,-1.0f,0.5f,1.0f,1.0f },
-		{ -1.0f,1.0f,0.5f,0.0f,0.0f },
-		{ 1.0f,-1.0f,0.5f,1.0f,1.0f },
-		{ -1.0f,-1.0f,0.5f,0.0f,1.0f },
-	};
-	D3D11_BUFFER_DESC bd = {};
-	bd.Usage = D3D11_USAGE_DEFAULT;
-	bd.ByteWidth = sizeof( FSQVertex ) * 6;
-	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	bd.CPUAccessFlags = 0u;
-	D3D11_SUBRESOURCE_DATA initData = {};
-	initData.pSysMem = vertices;
-	if( FAILED( hr = pDevice->CreateBuffer( &bd,&initData,&pVertexBuffer ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating vertex buffer" );
-	}
+RectI Graphics::GetSpriteBounds( int x, int y, const RectI& srcRect, const RectI& clip )
+{
+    return RectI( std::max( x, clip.left ), std::min( x + srcRect.GetWidth(), clip.right ),
+                  std::max( y, clip.top ), std::min( y + srcRect.GetHeight(), clip.bottom ) );
+}
 
-	
-	//////////////////////////////////////////
-	// create input layout for fullscreen quad
-	const D3D11_INPUT_ELEMENT_DESC ied[] =
-	{
-		{ "POSITION",0,DXGI_FORMAT_R32G32B32_FLOAT,0,0,D3D11_INPUT_PER_VERTEX_DATA,0 },
-		{ "TEXCOORD",0,DXGI_FORMAT_R32G32_FLOAT,0,12,D3D11_INPUT_PER_VERTEX_DATA,0 }
-	};
-
-	// Ignore the intellisense error "namespace has no member"
-	if( FAILED( hr = pDevice->CreateInputLayout( ied,2,
-		FramebufferShaders::FramebufferVSBytecode,
-		sizeof( FramebufferShaders::FramebufferVSBytecode ),
-		&pInputLayout ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating input layout" );
-	}
+void Graphics::ScrollFrame( int dx, int dy )
+{
+    const int width = ScreenWidth - abs( dx );
+    if( width <= 0 || abs( dy ) >= ScreenHeight )
+    {
+        return;
+    }
+    const int xSrc = std::max( -dx, 0 );
+    const int xDst = std::max( dx, 0 );
+    /* rows are processed away from the direction of movement so no source row is overwritten before it is read */
+    if( dy > 0 )
+    {
+        for( int y = ScreenHeight - 1; y >= dy; y-- )
+        {
+            memmove( &pSysBuffer[ y * ScreenWidth + xDst ], &pSysBuffer[ ( y - dy ) * ScreenWidth + xSrc ], sizeof( Color ) * width );
+        }
+    }
+    else
+    {
+        for( int y = 0; y < ScreenHeight + dy; y++ )
+        {
+            memmove( &pSysBuffer[ y * ScreenWidth + xDst ], &pSysBuffer[ ( y - dy ) * ScreenWidth + xSrc ], sizeof( Color ) * width );
+        }
+    }
+}
 
+void Graphics::EndFrame()
+{
+	pPresenter->Present( pSysBuffer,ScreenWidth,ScreenHeight );
+}
 
-	////////////////////////////////////////////////////
-	// Create sampler state for fullscreen textured quad
-	D3D11_SAMPLER_DESC sampDesc = {};
-	sampDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
-	sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
-	sampDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
-	sampDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
-	sampDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
-	sampDesc.MinLOD = 0;
-	sampDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	if( FAILED( hr = pDevice->CreateSamplerState( &sampDesc,&pSamplerState ) ) )
+void Graphics::BeginFrame( const bool bClear )
+{
+    frameNumber++;
+	// clear the sysbuffer
+	if( bClear )
 	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Creating sampler state" );
+		memset( pSysBuffer,0u,sizeof( Color ) * Graphics::ScreenHeight * Graphics::ScreenWidth );
 	}
-
-	// allocate memory for sysbuffer (16-byte aligned for faster access)
-	pSysBuffer = reinterpret_cast<Color*>( 
-		_aligned_malloc( sizeof( Color ) * Graphics::ScreenWidth * Graphics::ScreenHeight,16u ) );
 }
 
-Graphics::~Graphics()
+bool Graphics::ClipSprite( int& x, int& y, RectI& srcRect, const RectI& clipIn )
 {
-	// free sysbuffer memory (aligned free)
-	if( pSysBuffer )
-	{
-		_aligned_free( pSysBuffer );
-		pSysBuffer = nullptr;
-	}
-	// clear the state of the device context before destruction
-	if( pImmediateContext ) pImmediateContext->ClearState();
+    /* the clip rect of the current thread (render band) always applies */
+    const RectI clip( std::max( clipIn.left, clipRect.left ), std::min( clipIn.right, clipRect.right ),
+                      std::max( clipIn.top, clipRect.top ), std::min( clipIn.bottom, clipRect.bottom ) );
+    if( x < clip.left )
+    {
+        srcRect.left += clip.left - x;
+        x = clip.left;
+    }
+    if( y < clip.top )
+    {
+        srcRect.top += clip.top - y;
+        y = clip.top;
+    }
+    if( x + srcRect.GetWidth() > clip.right )
+    {
+        srcRect.right -= x + srcRect.GetWidth() - clip.right;
+    }
+    if( y + srcRect.GetHeight() > clip.bottom )
+    {
+        srcRect.bottom -= y + srcRect.GetHeight() - clip.bottom;
+    }
+    return srcRect.GetWidth() > 0 && srcRect.GetHeight() > 0;
 }
 
-RectI Graphics::GetScreenRect()
+void Graphics::DrawSprite( int x, int y, RectI srcRect, const RleSprite& s )
 {
-	return{ 0,ScreenWidth,0,ScreenHeight };
+    if( pRecorder )
+    {
+        DrawKey key( DrawKey::Type::RLE_SPRITE, x - srcRect.left, y - srcRect.top );
+        key.pSource = &s;
+        key.data[ 0 ] = s.GetId();
+        const RleSprite* pSprite = &s;
+        Record( key, GetSpriteBounds( x, y, srcRect, GetScreenRect() ), [=]( Graphics& gfx ) { gfx.DrawSprite( x, y, srcRect, *pSprite ); } );
+        return;
+    }
+    assert( srcRect.left >= 0 );
+    assert( srcRect.right <= s.GetWidth() );
+    assert( srcRect.top >= 0 );
+    assert( srcRect.bottom <= s.GetHeight() );
+    if( !ClipSprite( x, y, srcRect, GetScreenRect() ) )
+    {
+        return;
+    }
+
+    const Color* pPixels = s.GetPixels();
+    Color* pDstRow = &pSysBuffer[ y * Graphics::ScreenWidth + x ];
+    for( int sy = srcRect.top; sy < srcRect.bottom; sy++ )
+    {
+        for( const RleSprite::Span* pSpan = s.GetSpansBegin( sy ); pSpan != s.GetSpansEnd( sy ); ++pSpan )
+        {
+            /* clip the span against the source rect */
+            const int start = std::max( ( int )pSpan->x, srcRect.left );
+            const int end   = std::min( pSpan->x + pSpan->length, srcRect.right );
+            if( start < end )
+            {
+                memcpy( pDstRow + ( start - srcRect.left ), pPixels + pSpan->offset + ( start - pSpan->x ), sizeof( Color ) * ( end - start ) );
+            }
+            else if( pSpan->x >= srcRect.right )
+            {
+                break;  /* spans are ordered by x */
+            }
+        }
+        pDstRow += Graphics::ScreenWidth;
+    }
 }
 
-void Graphics::EndFrame()
+void Graphics::DrawSprite( int x, int y, RectI srcRect, const IndexedSprite& s, const Palette& palette )
 {
-	HRESULT hr;
+    if( pRecorder )
+    {
+        DrawKey key( DrawKey::Type::INDEXED_SPRITE, x - srcRect.left, y - srcRect.top );
+        key.pSource = &s;
+        key.data[ 0 ] = s.GetId();
+        key.data[ 1 ] = palette.GetId();
+        const IndexedSprite* pSprite = &s;
+        const Palette* pPalette = &palette;
+        Record( key, GetSpriteBounds( x, y, srcRect, GetScreenRect() ), [=]( Graphics& gfx ) { gfx.DrawSprite( x, y, srcRect, *pSprite, *pPalette ); } );
+        return;
+    }
+    assert( srcRect.left >= 0 );
+    assert( srcRect.right <= s.GetWidth() );
+    assert( srcRect.top >= 0 );
+    assert( srcRect.bottom <= s.GetHeight() );
+    if( !ClipSprite( x, y, srcRect, GetScreenRect() ) )
+    {
+        return;
+    }
 
-	// lock and map the adapter memory for copying over the sysbuffer
-	if( FAILED( hr = pImmediateContext->Map( pSysBufferTexture.Get(),0u,
-		D3D11_MAP_WRITE_DISCARD,0u,&mappedSysBufferTexture ) ) )
-	{
-		throw CHILI_GFX_EXCEPTION( hr,L"Mapping sysbuffer" );
-	}
-	// setup parameters for copy operation
-	Color* pDst = reinterpret_cast<Color*>(mappedSysBufferTexture.pData );
-	const size_t dstPitch = mappedSysBufferTexture.RowPitch / sizeof( Color );
-	const size_t srcPitch = Graphics::ScreenWidth;
-	const size_t rowBytes = srcPitch * sizeof( Color );
-	// perform the copy line-by-line
-	for( size_t y = 0u; y < Graphics::ScreenHeight; y++ )
-	{
-		memcpy( &pDst[ y * dstPitch ],&pSysBuffer[y * srcPitch],rowBytes );
-	}
-	// release the adapter memory
-	pImmediateContext->Unmap( pSysBufferTexture.Get(),0u );
-
-	// render offscreen scene texture to back buffer
-	pImmediateContext->IASetInputLayout( pInputLayout.Get() );
-	pImmediateContext->VSSetShader( pVertexShader.Get(),nullptr,0u );
-	pImmediateContext->PSSetShader( pPixelShader.Get(),nullptr,0u );
-	pImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
-	const UINT stride = sizeof( FSQVertex );
-	const UINT offset = 0u;
-	pImmediateContext->IASetVertexBuffers( 0u,1u,pVertexBuffer.GetAddressOf(),&stride,&offset );
-	pImmediateContext->PSSetShaderResources( 0u,1u,pSysBufferTextureView.GetAddressOf() );
-	pImmediateContext->PSSetSamplers( 0u,1u,pSamplerState.GetAddressOf() );
-	pImmediateContext->Draw( 6u,0u );
-
-	// flip back/front buffers
-	if( FAILED( hr = pSwapChain->Present( 1u,0u ) ) )
-	{
-		if( hr == DXGI_ERROR_DEVICE_REMOVED )
-		{
-			throw CHILI_GFX_EXCEPTION( pDevice->GetDeviceRemovedReason(),L"Presenting back buffer [device removed]" );
-		}
-		else
-		{
-			throw CHILI_GFX_EXCEPTION( hr,L"Presenting back buffer" );
-		}
-	}
+    const unsigned char* pIndices = s.GetIndices();
+    const Color* pColors = palette.GetColors();
+    Color* pDstRow = &pSysBuffer[ y * Graphics::ScreenWidth + x ];
+    for( int sy = srcRect.top; sy < srcRect.bottom; sy++ )
+    {
+        for( const IndexedSprite::Span* pSpan = s.GetSpansBegin( sy ); pSpan != s.GetSpansEnd( sy ); ++pSpan )
+        {
+            /* clip the span against the source rect */
+            const int start = std::max( ( int )pSpan->x, srcRect.left );
+            const int end   = std::min( pSpan->x + pSpan->length, srcRect.right );
+            if( start < end )
+            {
+                const unsigned char* pSrc = pIndices + pSpan->offset + ( start - pSpan->x );
+                Color* pDst = pDstRow + ( start - srcRect.left );
+                const int n = end - start;
+                int i = 0;
+                for( ; i + 4 <= n; i += 4 )
+                {
+                    pDst[ i ]     = pColors[ pSrc[ i ] ];
+                    pDst[ i + 1 ] = pColors[ pSrc[ i + 1 ] ];
+                    pDst[ i + 2 ] = pColors[ pSrc[ i + 2 ] ];
+                    pDst[ i + 3 ] = pColors[ pSrc[ i + 3 ] ];
+                }
+                for( ; i < n; i++ )
+                {
+                    pDst[ i ] = pColors[ pSrc[ i ] ];
+                }
+            }
+            else if( pSpan->x >= srcRect.right )
+            {
+                break;  /* spans are ordered by x */
+            }
+        }
+        pDstRow += Graphics::ScreenWidth;
+    }
 }
 
-void Graphics::BeginFrame()
+void Graphics::DrawOpaque( int x, int y, RectI srcRect, const Surface& s, unsigned int version )
 {
-	// clear the sysbuffer
-	memset( pSysBuffer,0u,sizeof( Color ) * Graphics::ScreenHeight * Graphics::ScreenWidth );
+    if( pRecorder )
+    {
+        DrawKey key( DrawKey::Type::OPAQUE, x - srcRect.left, y - srcRect.top );
+        key.pSource = &s;
+        key.data[ 0 ] = version;
+        const Surface* pSurface = &s;
+        Record( key, GetSpriteBounds( x, y, srcRect, GetScreenRect() ), [=]( Graphics& gfx ) { gfx.DrawOpaque( x, y, srcRect, *pSurface ); } );
+        return;
+    }
+    assert( srcRect.left >= 0 );
+    assert( srcRect.right <= s.GetWidth() );
+    assert( srcRect.top >= 0 );
+    assert( srcRect.bottom <= s.GetHeight() );
+    if( !ClipSprite( x, y, srcRect, GetScreenRect() ) )
+    {
+        return;
+    }
+
+    const int width  = srcRect.GetWidth();
+    const int height = srcRect.GetHeight();
+    Color* pDst      = &pSysBuffer[ y * Graphics::ScreenWidth + x ];
+
+    /* rows are contiguous in both buffers -> one single copy */
+    if( width == Graphics::ScreenWidth && width == s.GetWidth() )
+    {
+        memcpy( pDst, s.GetRow( srcRect.top ), sizeof( Color ) * width * height );
+        return;
+    }
+    /* plain cached copies, no streaming stores: the sprites drawn afterwards read the background again */
+    for( int sy = srcRect.top; sy < srcRect.bottom; sy++ )
+    {
+        memcpy( pDst, s.GetRow( sy ) + srcRect.left, sizeof( Color ) * width );
+        pDst += Graphics::ScreenWidth;
+    }
 }
 
 Color Graphics::GetPixel( int x, int y ) const
 {
+    assert( !pRecorder );   /* the frame buffer is not up to date while recording */
     assert( x >= 0 );
     assert( x < int( Graphics::ScreenWidth ) );
     assert( y >= 0 );
@@ -323,7 +320,14 @@ Color Graphics::GetPixel( int x, int y ) const
 
 void Graphics::PutPixel( int x,int y,Color c )
 {
-    if( x >= 0 && y >= 0 && x < Graphics::ScreenWidth && y < Graphics::ScreenHeight )
+    if( pRecorder )
+    {
+        DrawKey key( DrawKey::Type::PIXEL, x, y );
+        key.data[ 0 ] = c.dword;
+        Record( key, RectI( x, x + 1, y, y + 1 ), [=]( Graphics& gfx ) { gfx.PutPixel( x, y, c ); } );
+        return;
+    }
+    if( x >= clipRect.left && y >= clipRect.top && x < clipRect.right && y < clipRect.bottom )
     {
         pSysBuffer[ Graphics::ScreenWidth * y + x ] = c;
     }
@@ -331,55 +335,87 @@ void Graphics::PutPixel( int x,int y,Color c )
 
 void Graphics::DrawLine( int x1, int y1, int x2, int y2, Color c )
 {
-    int dx = x2 - x1;
-    int dy = y2 - y1;
+    if( pRecorder )
+    {
+        DrawKey key( DrawKey::Type::LINE, x1, y1 );
+        key.params[ 0 ] = x2 - x1;
+        key.params[ 1 ] = y2 - y1;
+        key.data[ 0 ] = c.dword;
+        const RectI bounds( std::min( x1, x2 ), std::max( x1, x2 ) + 1, std::min( y1, y2 ), std::max( y1, y2 ) + 1 );
+        Record( key, bounds, [=]( Graphics& gfx ) { gfx.DrawLine( x1, y1, x2, y2, c ); } );
+        return;
+    }
+    Color* const pBuffer = pSysBuffer;
+    Raster::Line( x1, y1, x2, y2, clipRect, [ pBuffer, c ]( const int x, const int y )
+    {
+        pBuffer[ Graphics::ScreenWidth * y + x ] = c;
+    } );
+}
 
-    if( dy == 0 && dx == 0 )
+void Graphics::DrawThickLine( int x1, int y1, int x2, int y2, int thickness, Color c )
+{
+    if( pRecorder )
     {
-        PutPixel( x1, y1, c );
+        DrawKey key( DrawKey::Type::THICK_LINE, x1, y1 );
+        key.params[ 0 ] = x2 - x1;
+        key.params[ 1 ] = y2 - y1;
+        key.params[ 2 ] = thickness;
+        key.data[ 0 ] = c.dword;
+        const RectI bounds( std::min( x1, x2 ) - thickness, std::max( x1, x2 ) + thickness + 1,
+                            std::min( y1, y2 ) - thickness, std::max( y1, y2 ) + thickness + 1 );
+        Record( key, bounds, [=]( Graphics& gfx ) { gfx.DrawThickLine( x1, y1, x2, y2, thickness, c ); } );
+        return;
     }
-    else if( abs( dy ) > abs( dx ) )
+    if( thickness <= 1 )
     {
-        if( dy < 0 )
-        {
-            int temp = x1;
-            x1 = x2;
-            x2 = temp;
-            temp = y1;
-            y1 = y2;
-            y2 = temp;
-        }
-        float m = ( float )dx / ( float )dy;
-        float b = x1 - m*y1;
-        for( int y = y1; y <= y2; y = y + 1 )
-        {
-            int x = ( int )( m*y + b + 0.5f );
-            PutPixel( x, y, c );
-        }
+        DrawLine( x1, y1, x2, y2, c );
+        return;
     }
-    else
+    Color* const pBuffer = pSysBuffer;
+    Raster::ThickLine( x1, y1, x2, y2, thickness, clipRect, [ pBuffer, c ]( const RectI& run )
     {
-        if( dx < 0 )
-        {
-            int temp = x1;
-            x1 = x2;
-            x2 = temp;
-            temp = y1;
-            y1 = y2;
-            y2 = temp;
-        }
-        float m = ( float )dy / ( float )dx;
-        float b = y1 - m*x1;
-        for( int x = x1; x <= x2; x = x + 1 )
+        for( int y = run.top; y < run.bottom; ++y )
         {
-            int y = ( int )( m*x + b + 0.5f );
-            PutPixel( x, y, c );
+            std::fill( pBuffer + Graphics::ScreenWidth * y + run.left, pBuffer + Graphics::ScreenWidth * y + run.right, c );
         }
+    } );
+}
+
+void Graphics::DrawHSpan( int x1, int x2, int y, Color c )
+{
+    if( pRecorder )
+    {
+        DrawKey key( DrawKey::Type::HSPAN, x1, y );
+        key.params[ 0 ] = x2 - x1;
+        key.data[ 0 ] = c.dword;
+        Record( key, RectI( x1, x2, y, y + 1 ), [=]( Graphics& gfx ) { gfx.DrawHSpan( x1, x2, y, c ); } );
+        return;
+    }
+    if( y < clipRect.top || y >= clipRect.bottom )
+    {
+        return;
+    }
+    x1 = std::max( x1, clipRect.left );
+    x2 = std::min( x2, clipRect.right );
+    if( x1 < x2 )
+    {
+        Color* const pRow = &pSysBuffer[ Graphics::ScreenWidth * y ];
+        std::fill( pRow + x1, pRow + x2, c );
     }
 }
 
 void Graphics::DrawRect( int x0, int y0, int x1, int y1, Color c )
 {
+    if( pRecorder )
+    {
+        DrawKey key( DrawKey::Type::RECT, std::min( x0, x1 ), std::min( y0, y1 ) );
+        key.params[ 0 ] = abs( x1 - x0 );
+        key.params[ 1 ] = abs( y1 - y0 );
+        key.data[ 0 ] = c.dword;
+        const RectI bounds( std::min( x0, x1 ), std::max( x0, x1 ), std::min( y0, y1 ), std::max( y0, y1 ) );
+        Record( key, bounds, [=]( Graphics& gfx ) { gfx.DrawRect( x0, y0, x1, y1, c ); } );
+        return;
+    }
     if( x0 > x1 )
     {
         std::swap( x0, x1 );
@@ -388,13 +424,11 @@ void Graphics::DrawRect( int x0, int y0, int x1, int y1, Color c )
     {
         std::swap( y0, y1 );
     }
-
+    y0 = std::max( y0, clipRect.top );
+    y1 = std::min( y1, clipRect.bottom );
     for( int y = y0; y < y1; ++y )
     {
-        for( int x = x0; x < x1; ++x )
-        {
-            PutPixel( x, y, c );
-        }
+        DrawHSpan( x0, x1, y, c );
     }
 }
 
@@ -434,43 +468,53 @@ void Graphics::DrawRectCorners( const RectF& rect, Color c )
     const int w = ( int )( r.right - r.left ) / 5;
     const int h = ( int )( r.bottom - r.top ) / 5;
 
-    const Vec2 tl = { r.left, r.top };
-    const Vec2 tr = { r.right, r.top };
-    const Vec2 bl = { r.left, r.bottom };
-    const Vec2 br = { r.right, r.bottom };
+    const int left = ( int )r.left;
+    const int right = ( int )r.right;
+    const int top = ( int )r.top;
+    const int bottom = ( int )r.bottom;
 
-    DrawLine( tl, { tl.x + w, tl.y }, c );
-    DrawLine( tl, { tl.x, tl.y + h }, c );
+    /* axis aligned corner lines including both end points */
+    DrawHSpan( left, left + w + 1, top, c );
+    DrawRect( left, top, left + 1, top + h + 1, c );
 
-    DrawLine( bl, { bl.x + w, bl.y }, c );
-    DrawLine( bl, { bl.x, bl.y - h }, c );
+    DrawHSpan( left, left + w + 1, bottom, c );
+    DrawRect( left, bottom - h, left + 1, bottom + 1, c );
 
-    DrawLine( tr, { tr.x - w, tr.y }, c );
-    DrawLine( tr, { tr.x, tr.y + h }, c );
-    
-    DrawLine( br, { br.x - w, br.y }, c );
-    DrawLine( br, { br.x, br.y - h }, c );
+    DrawHSpan( right - w, right + 1, top, c );
+    DrawRect( right, top, right + 1, top + h + 1, c );
+
+    DrawHSpan( right - w, right + 1, bottom, c );
+    DrawRect( right, bottom - h, right + 1, bottom + 1, c );
 }
 
 void Graphics::DrawCircle( int x, int y, int radius, Color c )
 {
-    const int rad_sq = radius * radius;
-    for( int y_loop = y - radius + 1; y_loop < y + radius; y_loop++ )
+    if( pRecorder )
     {
-        for( int x_loop = x - radius + 1; x_loop < x + radius; x_loop++ )
-        {
-            const int x_diff = x - x_loop;
-            const int y_diff = y - y_loop;
-            if( x_diff * x_diff + y_diff * y_diff <= rad_sq )
-            {
-                PutPixel( x_loop, y_loop, c );
-            }
-        }
+        DrawKey key( DrawKey::Type::CIRCLE, x, y );
+        key.params[ 0 ] = radius;
+        key.data[ 0 ] = c.dword;
+        Record( key, RectI( x - radius + 1, x + radius, y - radius + 1, y + radius ), [=]( Graphics& gfx ) { gfx.DrawCircle( x, y, radius, c ); } );
+        return;
     }
+    Color* const pBuffer = pSysBuffer;
+    Raster::Circle( x, y, radius, clipRect, [ pBuffer, c ]( const RectI& span )
+    {
+        std::fill( pBuffer + Graphics::ScreenWidth * span.top + span.left, pBuffer + Graphics::ScreenWidth * span.top + span.right, c );
+    } );
 }
 
 void Graphics::DrawCircleBorder( int centerX, int centerY, int radius, Color c )
-{    
+{
+    if( pRecorder )
+    {
+        DrawKey key( DrawKey::Type::CIRCLE_BORDER, centerX, centerY );
+        key.params[ 0 ] = radius;
+        key.data[ 0 ] = c.dword;
+        const int r = abs( radius );
+        Record( key, RectI( centerX - r, centerX + r + 1, centerY - r, centerY + r + 1 ), [=]( Graphics& gfx ) { gfx.DrawCircleBorder( centerX, centerY, radius, c ); } );
+        return;
+    }
     int rSquared = radius * radius;
     int xPivot = ( int )( radius * 0.707107f + 0.5f );
     for( int x = 0; x <= xPivot; x++ )
@@ -486,45 +530,3 @@ void Graphics::DrawCircleBorder( int centerX, int centerY, int radius, Color c )
         PutPixel( centerX - y, centerY - x, c );
     }
 }
-
-//////////////////////////////////////////////////
-//           Graphics Exception
-Graphics::Exception::Exception( HRESULT hr,const std::wstring& note,const wchar_t* file,unsigned int line )
-	:
-	ChiliException( file,line,note ),
-	hr( hr )
-{}
-
-std::wstring Graphics::Exception::GetFullMessage() const
-{
-	const std::wstring empty = L"";
-	const std::wstring errorName = GetErrorName();
-	const std::wstring errorDesc = GetErrorDescription();
-	const std::wstring& note = GetNote();
-	const std::wstring location = GetLocation();
-	return    (!errorName.empty() ? std::wstring( L"Error: " ) + errorName + L"\n"
-		: empty)
-		+ (!errorDesc.empty() ? std::wstring( L"Description: " ) + errorDesc + L"\n"
-			: empty)
-		+ (!note.empty() ? std::wstring( L"Note: " ) + note + L"\n"
-			: empty)
-		+ (!location.empty() ? std::wstring( L"Location: " ) + location
-			: empty);
-}
-
-std::wstring Graphics::Exception::GetErrorName() const
-{
-	return DXGetErrorString( hr );
-}
-
-std::wstring Graphics::Exception::GetErrorDescription() const
-{
-	std::array<wchar_t,512> wideDescription;
-	DXGetErrorDescription( hr,wideDescription.data(),wideDescription.size() );
-	return wideDescription.data();
-}
-
-std::wstring Graphics::Exception::GetExceptionType() const
-{
-	return L"Chili Graphics Exception";
-}
\ No newline at end of file
@@ -19,48 +19,34 @@
 *	along with The Chili DirectX Framework.  If not, see <http://www.gnu.org/licenses/>.  *
 ******************************************************************************************/
 #pragma once
-#include "ChiliWin.h"
-#include <d3d11.h>
-#include <wrl.h>
-#include "ChiliException.h"
+#include "Presenter.h"
 #include "Colors.h"
 #include "Surface.h"
+#include "RleSprite.h"
+#include "IndexedSprite.h"
 #include "RectI.h"
 #include "RectF.h"
 #include "Vec2.h"
+#include "DrawKey.h"
+#include <functional>
+#include <memory>
+
+class BandRenderer;
 #include <cassert>
 
 class Graphics
 {
 public:
-	class Exception : public ChiliException
-	{
-	public:
-		Exception( HRESULT hr,const std::wstring& note,const wchar_t* file,unsigned int line );
-		std::wstring GetErrorName() const;
-		std::wstring GetErrorDescription() const;
-		virtual std::wstring GetFullMessage() const override;
-		virtual std::wstring GetExceptionType() const override;
-	private:
-		HRESULT hr;
-	};
-private:
-	// vertex format for the framebuffer fullscreen textured quad
-	struct FSQVertex
-	{
-		float x,y,z;		// position
-		float u,v;			// texcoords
-	};
-public:
-	Graphics( class HWNDKey& key );
+	Graphics( class HWNDKey& key );                             /* window output, see D3DPresenter */
+    explicit Graphics( std::unique_ptr< Presenter > presenter );  /* any other output, e.g. HeadlessPresenter */
 	Graphics( const Graphics& ) = delete;
 	Graphics& operator=( const Graphics& ) = delete;
 	void EndFrame();
-	void BeginFrame();
+	void BeginFrame( const bool bClear = true );    /* no clear needed if the whole screen is drawn anyway */
     Color GetPixel( int x, int y ) const;
 	void PutPixel( int x,int y,int r,int g,int b )
 	{
-		PutPixel( x,y,{ unsigned char( r ),unsigned char( g ),unsigned char( b ) } );
+		PutPixel( x,y,{ (unsigned char)r,(unsigned char)g,(unsigned char)b } );
 	}
 	void PutPixel( int x,int y,Color c );
     void DrawLine( int x1, int y1, int x2, int y2, Color c );
@@ -72,6 +58,10 @@ public:
     {
         DrawLine( p1.x, p1.y, p2.x, p2.y, c );
     }
+    /* pixels x1 <= x < x2 of row y */
+    void DrawHSpan( int x1, int x2, int y, Color c );
+    /* line with a brush of thickness pixels across the main direction, cheaper than several parallel lines */
+    void DrawThickLine( int x1, int y1, int x2, int y2, int thickness, Color c );
     void DrawRect( int x0, int y0, int x1, int y1, Color c );
     void DrawRect( const RectF& rect, Color c )
     {
@@ -115,56 +105,76 @@ public:
     template<typename E>
     void DrawSprite( int x, int y, RectI srcRect, const RectI& clip, const Surface& s, E effect )
     {
+        if( pRecorder )
+        {
+            DrawKey key( DrawKey::Type::SPRITE, x - srcRect.left, y - srcRect.top );
+            key.pSource = &s;
+            key.setEffect( effect );
+            const Surface* pSurface = &s;
+            Record( key, GetSpriteBounds( x, y, srcRect, clip ), [=]( Graphics& gfx ) { gfx.DrawSprite( x, y, srcRect, clip, *pSurface, effect ); } );
+            return;
+        }
         assert( srcRect.left >= 0 );
         assert( srcRect.right <= s.GetWidth() );
         assert( srcRect.top >= 0 );
         assert( srcRect.bottom <= s.GetHeight() );
-        if( x < clip.left )
-        {
-            srcRect.left += clip.left - x;
-            x = clip.left;
-        }
-        if( y < clip.top )
-        {
-            srcRect.top += clip.top - y;
-            y = clip.top;
-        }
-        if( x + srcRect.GetWidth() > clip.right )
+        if( !ClipSprite( x, y, srcRect, clip ) )
         {
-            srcRect.right -= x + srcRect.GetWidth() - clip.right;
-        }
-        if( y + srcRect.GetHeight() > clip.bottom )
-        {
-            srcRect.bottom -= y + srcRect.GetHeight() - clip.bottom;
+            return;
         }
+        const int width = srcRect.GetWidth();
+        /* the rect is clipped already, so the effect works on whole rows without any further checks */
+        Color* pDst = &pSysBuffer[ y * Graphics::ScreenWidth + x ];
         for( int sy = srcRect.top; sy < srcRect.bottom; sy++ )
         {
-            for( int sx = srcRect.left; sx < srcRect.right; sx++ )
-            {
-                effect(
-                    s.GetPixel( sx, sy ),
-                    x + sx - srcRect.left,
-                    y + sy - srcRect.top,
-                    *this
-                );
-            }
+            effect.DrawRow( s.GetRow( sy ) + srcRect.left, pDst, width );
+            pDst += Graphics::ScreenWidth;
         }
     }
+    /* run-length encoded sprites: only the opaque spans are copied, clipped against srcRect and the screen */
+    void DrawSprite( int x, int y, const RleSprite& s )
+    {
+        DrawSprite( x, y, s.GetRect(), s );
+    }
+    void DrawSprite( int x, int y, RectI srcRect, const RleSprite& s );
+    /* palette indexed sprites: the opaque spans are expanded through the palette (the own one of the sprite or a
+       palette swap of it, which has to stay alive until the frame is rendered) */
+    void DrawSprite( int x, int y, const IndexedSprite& s )
+    {
+        DrawSprite( x, y, s.GetRect(), s, s.GetPalette() );
+    }
+    void DrawSprite( int x, int y, RectI srcRect, const IndexedSprite& s )
+    {
+        DrawSprite( x, y, srcRect, s, s.GetPalette() );
+    }
+    void DrawSprite( int x, int y, RectI srcRect, const IndexedSprite& s, const Palette& palette );
+    /* moves the frame buffer content by dx/dy pixels (uncovered pixels keep their old content) */
+    void ScrollFrame( int dx, int dy );
+    unsigned int GetFrameNumber() const         /* counts the BeginFrame() calls */
+    {
+        return frameNumber;
+    }
+    /* opaque copy of srcRect, whole rows are memcpy'd straight into the frame buffer (same result as DrawSprite with SpriteEffect::Copy).
+       version: has to change whenever the pixels of s change (retained layers), else dirty tracking keeps the old image */
+    void DrawOpaque( int x, int y, RectI srcRect, const Surface& s, unsigned int version = 0 );
+    /* clip rect of the calling thread, no pixel outside of it is touched (screen rect by default) */
+    static void SetClipRect( const RectI& clip );
+    static RectI GetClipRect();
+    /* parallel rendering: between these calls the draw functions are not executed but recorded by the BandRenderer */
+    void BeginRecording( BandRenderer& renderer );
+    void EndRecording();
 	~Graphics();
 private:
-	Microsoft::WRL::ComPtr<IDXGISwapChain>				pSwapChain;
-	Microsoft::WRL::ComPtr<ID3D11Device>				pDevice;
-	Microsoft::WRL::ComPtr<ID3D11DeviceContext>			pImmediateContext;
-	Microsoft::WRL::ComPtr<ID3D11RenderTargetView>		pRenderTargetView;
-	Microsoft::WRL::ComPtr<ID3D11Texture2D>				pSysBufferTexture;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	pSysBufferTextureView;
-	Microsoft::WRL::ComPtr<ID3D11PixelShader>			pPixelShader;
-	Microsoft::WRL::ComPtr<ID3D11VertexShader>			pVertexShader;
-	Microsoft::WRL::ComPtr<ID3D11Buffer>				pVertexBuffer;
-	Microsoft::WRL::ComPtr<ID3D11InputLayout>			pInputLayout;
-	Microsoft::WRL::ComPtr<ID3D11SamplerState>			pSamplerState;
-	D3D11_MAPPED_SUBRESOURCE							mappedSysBufferTexture;
+    /* bounds: screen pixels the command may touch */
+    void Record( const DrawKey& key, const RectI& bounds, std::function< void( Graphics& ) > command );
+    static RectI GetSpriteBounds( int x, int y, const RectI& srcRect, const RectI& clip );
+    /* clips srcRect and moves x/y accordingly, returns false if nothing is left to draw */
+    static bool ClipSprite( int& x, int& y, RectI& srcRect, const RectI& clip );
+    std::unique_ptr< Presenter >                        pPresenter;
 	Color*                                              pSysBuffer = nullptr;
+    BandRenderer*                                       pRecorder = nullptr;
+    unsigned int                                        frameNumber = 0;
+    static thread_local RectI                           clipRect;
 public:
 	static constexpr int ScreenWidth = 1000;
 	static constexpr int ScreenHeight = 600;
@@ -0,0 +1,64 @@
+#include "GunSprites.h"
+#include "Raster.h"
+#include <cassert>
+#include <algorithm>
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+namespace
+{
+    const Color chroma = Colors::Magenta;
+}
+
+GunSprites::GunSprites( const float gunLength, const Color team, const int div )
+    :
+    m_reach( std::max( 7, ( int )gunLength + 3 ) / div ),
+    m_strip( renderStrip( gunLength / div, team, div ), chroma )
+{
+}
+
+Surface GunSprites::renderStrip( const float gunLength, const Color team, const int div )
+{
+    /* sizes of the parts, at least one pixel when zoomed out */
+    const int turretRadius = std::max( 7 / div, 1 );
+    const int barrelThickness = std::max( 5 / div, 1 );
+    const int ringRadius = std::max( 4 / div, 1 );
+    const int muzzleRadius = std::max( 2 / div, 1 );
+
+    assert( team != chroma );
+    const int cell = 2 * m_reach + 1;
+    Surface strip( nAngles * cell, cell );
+    strip.Fill( strip.GetRect(), chroma );
+
+    const Color colorGun = { 115, 115, 115 };
+    const Color colorGun2 = { 75, 75, 75 };
+    const auto fill = [ &strip ]( const Color c )
+    {
+        return [ &strip, c ]( const RectI& rect ) { strip.Fill( rect, c ); };
+    };
+    for( int i = 0; i < nAngles; ++i )
+    {
+        /* the old per frame math: float orientation, cos/sin of <math.h> (double), truncated. A double angle puts
+           the axis aligned muzzles one pixel further out */
+        const float angle = 2.0f * ( float )M_PI * i / nAngles;
+        const Vei2 muzzle( ( int )( gunLength * cos( ( double )angle ) ), ( int )( gunLength * sin( ( double )angle ) ) );
+        m_vMuzzleOffsets.push_back( muzzle );
+        m_vCellRects.emplace_back( Vei2( i * cell, 0 ), cell, cell );
+
+        /* same parts and pixel rules (Raster) as the gun drawn directly: turret, barrel, barrel ring, muzzle */
+        const RectI& clip = m_vCellRects.back();
+        const int x = i * cell + m_reach;
+        const int y = m_reach;
+        Raster::Circle( x, y, turretRadius, clip, fill( team ) );
+        Raster::ThickLine( x, y, x + muzzle.x, y + muzzle.y, barrelThickness, clip, fill( colorGun ) );
+        Raster::Circle( ( x + x + muzzle.x ) / 2, ( y + y + muzzle.y ) / 2, ringRadius, clip, fill( team ) );
+        Raster::Circle( x + muzzle.x, y + muzzle.y, muzzleRadius, clip, fill( colorGun2 ) );
+    }
+    return strip;
+}
+
+int GunSprites::angleIndex( const float orientation )
+{
+    const int idx = ( int )floor( orientation * ( nAngles / ( 2.0f * ( float )M_PI ) ) + 0.5f ) % nAngles;
+    return idx < 0 ? idx + nAngles : idx;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include "Graphics.h"
+#include "RleSprite.h"
+#include "Vei2.h"
+
+/* tank gun (turret circle, barrel, muzzle) pre-rendered at nAngles discrete orientations into one chroma keyed strip,
+   plus the muzzle position of every orientation. Drawing a gun is a single RLE blit, neither drawing nor the shot
+   effect needs any trigonometry */
+class GunSprites
+{
+public:
+    static constexpr int nAngles = 64;
+    /* gunLength: from the unit center to the muzzle in pixels, team: colour of the turret circles,
+       div > 1: gun of the zoomed out view, all lengths and radii divided by div */
+    GunSprites( const float gunLength, const Color team, const int div = 1 );
+
+    /* orientation in radians (any range) -> nearest of the pre-rendered angles */
+    static int angleIndex( const float orientation );
+    /* gun of unit center pos */
+    void draw( Graphics& gfx, const Vei2& pos, const int angleIdx ) const
+    {
+        gfx.DrawSprite( pos.x - m_reach, pos.y - m_reach, m_vCellRects[ angleIdx ], m_strip );
+    }
+    /* muzzle relative to the unit center */
+    const Vei2& getMuzzleOffset( const int angleIdx ) const
+    {
+        return m_vMuzzleOffsets[ angleIdx ];
+    }
+    int getReach() const            /* farthest pixel from the unit center in x or y */
+    {
+        return m_reach;
+    }
+private:
+    Surface renderStrip( const float gunLength, const Color team, const int div );     /* fills the tables as well */
+
+    int m_reach;
+    std::vector< Vei2 > m_vMuzzleOffsets;
+    std::vector< RectI > m_vCellRects;      /* one square cell per angle in m_strip, unit center in the middle */
+    RleSprite m_strip;
+};
@@ -0,0 +1,220 @@
+#include "HeadlessPresenter.h"
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <cctype>
+#include <algorithm>
+
+namespace
+{
+    uint32_t Crc32( const unsigned char* pData, size_t size, uint32_t crc = 0u )
+    {
+        static const auto table = []()
+        {
+            std::vector< uint32_t > t( 256 );
+            for( uint32_t n = 0; n < 256; n++ )
+            {
+                uint32_t c = n;
+                for( int k = 0; k < 8; k++ )
+                {
+                    c = ( c & 1u ) ? 0xEDB88320u ^ ( c >> 1 ) : c >> 1;
+                }
+                t[ n ] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for( size_t i = 0; i < size; i++ )
+        {
+            crc = table[ ( crc ^ pData[ i ] ) & 0xFFu ] ^ ( crc >> 8 );
+        }
+        return ~crc;
+    }
+
+    void PutBigEndian( std::vector< unsigned char >& v, const uint32_t value )
+    {
+        v.push_back( ( unsigned char )( value >> 24 ) );
+        v.push_back( ( unsigned char )( value >> 16 ) );
+        v.push_back( ( unsigned char )( value >> 8 ) );
+        v.push_back( ( unsigned char )value );
+    }
+
+    void WriteChunk( std::ofstream& file, const char* type, const std::vector< unsigned char >& data )
+    {
+        std::vector< unsigned char > chunk;
+        PutBigEndian( chunk, ( uint32_t )data.size() );
+        chunk.insert( chunk.end(), type, type + 4 );
+        chunk.insert( chunk.end(), data.begin(), data.end() );
+        /* the crc covers type and data, not the length */
+        PutBigEndian( chunk, Crc32( chunk.data() + 4, chunk.size() - 4 ) );
+        file.write( reinterpret_cast< const char* >( chunk.data() ), chunk.size() );
+    }
+
+    /* skips white space and # comments of the PPM header */
+    int ReadPPMValue( std::ifstream& file )
+    {
+        int c = file.get();
+        while( c == '#' || isspace( c ) )
+        {
+            if( c == '#' )
+            {
+                while( c != '\n' && c != EOF )
+                {
+                    c = file.get();
+                }
+            }
+            c = file.get();
+        }
+        int value = 0;
+        bool bDigits = false;
+        while( c >= '0' && c <= '9' )
+        {
+            value = value * 10 + ( c - '0' );
+            bDigits = true;
+            c = file.get();
+        }
+        return bDigits ? value : -1;    /* the single white space after the value is consumed */
+    }
+}
+
+HeadlessPresenter::HeadlessPresenter( const bool bCopyFrame )
+    :
+    bCopyFrame( bCopyFrame )
+{}
+
+void HeadlessPresenter::Present( const Color* pFrame, int width_in, int height_in )
+{
+    nFrames++;
+    if( !bCopyFrame )
+    {
+        return;
+    }
+    width = width_in;
+    height = height_in;
+    frame.resize( size_t( width ) * height );
+    memcpy( frame.data(), pFrame, frame.size() * sizeof( Color ) );
+}
+
+bool HeadlessPresenter::SavePPM( const std::string& filename ) const
+{
+    return SavePPM( filename, frame, width, height );
+}
+
+bool HeadlessPresenter::SavePNG( const std::string& filename ) const
+{
+    return SavePNG( filename, frame, width, height );
+}
+
+bool HeadlessPresenter::SavePPM( const std::string& filename, const std::vector< Color >& pixels, int width, int height )
+{
+    assert( pixels.size() == size_t( width ) * height );
+    std::ofstream file( filename, std::ios::binary );
+    if( !file )
+    {
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    std::vector< unsigned char > row( size_t( width ) * 3 );
+    for( int y = 0; y < height; y++ )
+    {
+        const Color* pSrc = &pixels[ size_t( y ) * width ];
+        for( int x = 0; x < width; x++ )
+        {
+            row[ x * 3 ]     = pSrc[ x ].GetR();
+            row[ x * 3 + 1 ] = pSrc[ x ].GetG();
+            row[ x * 3 + 2 ] = pSrc[ x ].GetB();
+        }
+        file.write( reinterpret_cast< const char* >( row.data() ), row.size() );
+    }
+    return bool( file );
+}
+
+bool HeadlessPresenter::SavePNG( const std::string& filename, const std::vector< Color >& pixels, int width, int height )
+{
+    assert( pixels.size() == size_t( width ) * height );
+    std::ofstream file( filename, std::ios::binary );
+    if( !file )
+    {
+        return false;
+    }
+    static const unsigned char signature[ 8 ] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write( reinterpret_cast< const char* >( signature ), sizeof( signature ) );
+
+    std::vector< unsigned char > header;
+    PutBigEndian( header, ( uint32_t )width );
+    PutBigEndian( header, ( uint32_t )height );
+    header.insert( header.end(), { 8, 2, 0, 0, 0 } );   /* 8 bit RGB, deflate, adaptive filtering, no interlace */
+    WriteChunk( file, "IHDR", header );
+
+    /* raw scanlines: filter type 0 followed by the RGB bytes */
+    std::vector< unsigned char > raw;
+    raw.reserve( size_t( width * 3 + 1 ) * height );
+    for( int y = 0; y < height; y++ )
+    {
+        raw.push_back( 0 );
+        const Color* pSrc = &pixels[ size_t( y ) * width ];
+        for( int x = 0; x < width; x++ )
+        {
+            raw.push_back( pSrc[ x ].GetR() );
+            raw.push_back( pSrc[ x ].GetG() );
+            raw.push_back( pSrc[ x ].GetB() );
+        }
+    }
+
+    /* zlib stream of stored (uncompressed) deflate blocks, at most 65535 bytes each */
+    std::vector< unsigned char > zlib = { 0x78, 0x01 };
+    size_t pos = 0;
+    do
+    {
+        const size_t size = std::min< size_t >( raw.size() - pos, 65535u );
+        const bool bLast = pos + size == raw.size();
+        zlib.push_back( bLast ? 1 : 0 );
+        zlib.push_back( ( unsigned char )size );
+        zlib.push_back( ( unsigned char )( size >> 8 ) );
+        zlib.push_back( ( unsigned char )~size );
+        zlib.push_back( ( unsigned char )( ~size >> 8 ) );
+        zlib.insert( zlib.end(), raw.begin() + pos, raw.begin() + pos + size );
+        pos += size;
+    }
+    while( pos < raw.size() );
+    uint32_t a = 1u;
+    uint32_t b = 0u;
+    for( const unsigned char c : raw )
+    {
+        a = ( a + c ) % 65521u;
+        b = ( b + a ) % 65521u;
+    }
+    PutBigEndian( zlib, ( b << 16 ) | a );
+    WriteChunk( file, "IDAT", zlib );
+    WriteChunk( file, "IEND", {} );
+    return bool( file );
+}
+
+bool HeadlessPresenter::LoadPPM( const std::string& filename, std::vector< Color >& pixels, int& width, int& height )
+{
+    std::ifstream file( filename, std::ios::binary );
+    if( !file || file.get() != 'P' || file.get() != '6' )
+    {
+        return false;
+    }
+    width = ReadPPMValue( file );
+    height = ReadPPMValue( file );
+    const int maxValue = ReadPPMValue( file );
+    if( width <= 0 || height <= 0 || maxValue != 255 )
+    {
+        return false;
+    }
+    std::vector< unsigned char > rgb( size_t( width ) * height * 3 );
+    file.read( reinterpret_cast< char* >( rgb.data() ), rgb.size() );
+    if( !file )
+    {
+        return false;
+    }
+    pixels.resize( size_t( width ) * height );
+    for( size_t i = 0; i < pixels.size(); i++ )
+    {
+        pixels[ i ] = Color( rgb[ i * 3 ], rgb[ i * 3 + 1 ], rgb[ i * 3 + 2 ] );
+    }
+    return true;
+}
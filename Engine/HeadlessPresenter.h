@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "Presenter.h"
+
+/* keeps the presented frame in memory instead of showing it, for benchmarks and image comparisons without a window */
+class HeadlessPresenter : public Presenter
+{
+public:
+    /* bCopyFrame false: Present() only counts the frame, so the rasteriser is measured without any present cost */
+    HeadlessPresenter( const bool bCopyFrame = true );
+    void Present( const Color* pFrame, int width, int height ) override;
+
+    void SetCopyFrame( const bool bCopy )
+    {
+        bCopyFrame = bCopy;
+    }
+    const std::vector< Color >& GetFrame() const    /* last copied frame */
+    {
+        return frame;
+    }
+    int GetWidth() const
+    {
+        return width;
+    }
+    int GetHeight() const
+    {
+        return height;
+    }
+    int GetNumFrames() const                        /* all Present() calls, copied or not */
+    {
+        return nFrames;
+    }
+
+    /* last copied frame as binary PPM (P6) or as PNG (24 bit, uncompressed deflate blocks), false if writing failed */
+    bool SavePPM( const std::string& filename ) const;
+    bool SavePNG( const std::string& filename ) const;
+    static bool SavePPM( const std::string& filename, const std::vector< Color >& pixels, int width, int height );
+    static bool SavePNG( const std::string& filename, const std::vector< Color >& pixels, int width, int height );
+    /* binary PPM as written by SavePPM(), false if the file is missing or not a P6 image with 8 bit channels */
+    static bool LoadPPM( const std::string& filename, std::vector< Color >& pixels, int& width, int& height );
+private:
+    bool bCopyFrame;
+    std::vector< Color > frame;
+    int width = 0;
+    int height = 0;
+    int nFrames = 0;
+};
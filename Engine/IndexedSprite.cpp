@@ -0,0 +1,257 @@
+#include "IndexedSprite.h"
+#include <cassert>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+    unsigned int nextPaletteId()
+    {
+        static std::atomic< unsigned int > nextId( 1 );
+        return nextId++;
+    }
+
+    struct ColorCount
+    {
+        Color c;
+        int count;
+    };
+    int channel( const Color c, const int ch )
+    {
+        return ch == 0 ? c.GetR() : ( ch == 1 ? c.GetG() : c.GetB() );
+    }
+
+    /* median cut: the box with the largest colour range is split at the median (weighted by pixel count) of that
+       channel until there are nBoxes boxes or nothing is left to split */
+    std::vector< std::vector< ColorCount > > medianCut( std::vector< ColorCount > vColors, const int nBoxes )
+    {
+        std::vector< std::vector< ColorCount > > vBoxes;
+        vBoxes.push_back( std::move( vColors ) );
+        while( ( int )vBoxes.size() < nBoxes )
+        {
+            int best = -1;
+            int bestRange = 0;
+            int bestChannel = 0;
+            for( int i = 0; i < ( int )vBoxes.size(); ++i )
+            {
+                if( vBoxes[ i ].size() < 2 )
+                {
+                    continue;
+                }
+                for( int ch = 0; ch < 3; ++ch )
+                {
+                    const auto minMax = std::minmax_element( vBoxes[ i ].begin(), vBoxes[ i ].end(), [ ch ]( const ColorCount& a, const ColorCount& b )
+                    {
+                        return channel( a.c, ch ) < channel( b.c, ch );
+                    } );
+                    const int range = channel( minMax.second->c, ch ) - channel( minMax.first->c, ch );
+                    if( range > bestRange )
+                    {
+                        best = i;
+                        bestRange = range;
+                        bestChannel = ch;
+                    }
+                }
+            }
+            if( best < 0 )
+            {
+                break;
+            }
+
+            std::vector< ColorCount >& box = vBoxes[ best ];
+            std::sort( box.begin(), box.end(), [ bestChannel ]( const ColorCount& a, const ColorCount& b )
+            {
+                return channel( a.c, bestChannel ) < channel( b.c, bestChannel );
+            } );
+            int total = 0;
+            for( const auto& cc : box )
+            {
+                total += cc.count;
+            }
+            size_t split = 1;
+            for( int sum = box[ 0 ].count; split < box.size() - 1 && 2 * sum < total; ++split )
+            {
+                sum += box[ split ].count;
+            }
+            std::vector< ColorCount > upper( box.begin() + split, box.end() );
+            box.resize( split );
+            vBoxes.push_back( std::move( upper ) );
+        }
+        return vBoxes;
+    }
+}
+
+Palette::Palette()
+    :
+    id( nextPaletteId() )
+{
+    colors.fill( Colors::Magenta );     /* unused entries */
+}
+
+unsigned char Palette::Add( Color c )
+{
+    assert( nUsed < nColors );
+    colors[ nUsed ] = c;
+    id = nextPaletteId();
+    return ( unsigned char )nUsed++;
+}
+
+void Palette::SetColor( unsigned char idx, Color c )
+{
+    assert( idx != transparent && idx < nUsed );
+    colors[ idx ] = c;
+    id = nextPaletteId();
+}
+
+int Palette::Find( Color c ) const
+{
+    for( int i = 1; i < nUsed; ++i )
+    {
+        if( colors[ i ] == c )
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+Palette Palette::Substituted( Color from, Color to ) const
+{
+    Palette p( *this );
+    for( int i = 1; i < nUsed; ++i )
+    {
+        if( p.colors[ i ] == from )
+        {
+            p.colors[ i ] = to;
+        }
+    }
+    p.id = nextPaletteId();
+    return p;
+}
+
+Palette Palette::Filled( Color c ) const
+{
+    Palette p( *this );
+    std::fill( p.colors.begin() + 1, p.colors.begin() + nUsed, c );
+    p.id = nextPaletteId();
+    return p;
+}
+
+IndexedSprite::IndexedSprite( const Surface& s, Color chroma, const std::vector< Color >& keyColors )
+    :
+    IndexedSprite( s, s.GetRect(), chroma, keyColors )
+{
+}
+
+IndexedSprite::IndexedSprite( const Surface& s, const RectI& srcRect, Color chroma, const std::vector< Color >& keyColors )
+    :
+    id( NextId() ),
+    width( srcRect.GetWidth() ),
+    height( srcRect.GetHeight() )
+{
+    assert( width <= 0xffff );
+    assert( srcRect.IsContainedBy( s.GetRect() ) );
+    assert( keyColors.size() < Palette::nColors - 1 );
+
+    /* histogram of the opaque colours, key colours excluded */
+    std::unordered_map< unsigned int, int > histogram;
+    std::unordered_map< unsigned int, unsigned char > colorToIdx;
+    for( int y = srcRect.top; y < srcRect.bottom; y++ )
+    {
+        const Color* pRow = s.GetRow( y );
+        for( int x = srcRect.left; x < srcRect.right; x++ )
+        {
+            if( pRow[ x ] != chroma )
+            {
+                histogram[ pRow[ x ].dword ]++;
+            }
+        }
+    }
+    nSourceColors = ( int )histogram.size();
+    for( const Color key : keyColors )
+    {
+        if( key != chroma && histogram.erase( key.dword ) > 0 )
+        {
+            colorToIdx[ key.dword ] = palette.Add( key );
+        }
+    }
+
+    /* palette: every colour gets an entry of its own if they fit, else one entry per median cut box (its average) */
+    std::vector< ColorCount > vColors;
+    vColors.reserve( histogram.size() );
+    for( const auto& h : histogram )
+    {
+        vColors.push_back( { Color( h.first ), h.second } );
+    }
+    const int nFree = Palette::nColors - palette.GetNumUsed();
+    if( ( int )vColors.size() <= nFree )
+    {
+        for( const auto& cc : vColors )
+        {
+            colorToIdx[ cc.c.dword ] = palette.Add( cc.c );
+        }
+    }
+    else
+    {
+        for( const auto& box : medianCut( std::move( vColors ), nFree ) )
+        {
+            unsigned int r = 0, g = 0, b = 0, total = 0;
+            for( const auto& cc : box )
+            {
+                r += cc.c.GetR() * cc.count;
+                g += cc.c.GetG() * cc.count;
+                b += cc.c.GetB() * cc.count;
+                total += cc.count;
+            }
+            const unsigned char idx = palette.Add( Color( ( unsigned char )( r / total ), ( unsigned char )( g / total ), ( unsigned char )( b / total ) ) );
+            for( const auto& cc : box )
+            {
+                colorToIdx[ cc.c.dword ] = idx;
+            }
+        }
+    }
+
+    /* spans of opaque pixels, same layout as RleSprite */
+    rowStarts.reserve( height + 1 );
+    for( int y = 0; y < height; y++ )
+    {
+        rowStarts.push_back( ( int )spans.size() );
+
+        const Color* pRow = s.GetRow( srcRect.top + y ) + srcRect.left;
+        int x = 0;
+        while( x < width )
+        {
+            /* skip transparent pixels */
+            while( x < width && pRow[ x ] == chroma )
+            {
+                x++;
+            }
+            if( x == width )
+            {
+                break;
+            }
+            /* opaque run */
+            Span span;
+            span.x      = ( unsigned short )x;
+            span.offset = ( unsigned int )indices.size();
+            while( x < width && pRow[ x ] != chroma )
+            {
+                indices.push_back( colorToIdx[ pRow[ x ].dword ] );
+                x++;
+            }
+            span.length = ( unsigned short )( x - span.x );
+            spans.push_back( span );
+        }
+    }
+    rowStarts.push_back( ( int )spans.size() );
+
+    spans.shrink_to_fit();
+    indices.shrink_to_fit();
+}
+
+unsigned int IndexedSprite::NextId()
+{
+    static std::atomic< unsigned int > nextId( 1 );
+    return nextId++;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include "Surface.h"
+#include "Colors.h"
+#include "RectI.h"
+
+/* 256 colours of an IndexedSprite, index 0 is reserved for transparent pixels. Changing a colour gives the palette
+   a new id (copies share it), the frame diffing of the BandRenderer relies on it */
+class Palette
+{
+public:
+    static constexpr int nColors = 256;
+    static constexpr unsigned char transparent = 0;
+public:
+    Palette();
+
+    Color GetColor( unsigned char idx ) const
+    {
+        return colors[ idx ];
+    }
+    const Color* GetColors() const
+    {
+        return colors.data();
+    }
+    int GetNumUsed() const              /* entries 1 .. GetNumUsed() - 1 belong to the sprite */
+    {
+        return nUsed;
+    }
+    unsigned int GetId() const
+    {
+        return id;
+    }
+    /* returns the new index */
+    unsigned char Add( Color c );
+    void SetColor( unsigned char idx, Color c );
+    /* -1 if c is not in the palette */
+    int Find( Color c ) const;
+
+    /* palette swaps: every entry of colour from replaced by to (team colours) */
+    Palette Substituted( Color from, Color to ) const;
+    /* every used entry replaced by c (damage flash) */
+    Palette Filled( Color c ) const;
+private:
+    std::array< Color, nColors > colors;
+    int nUsed = 1;
+    unsigned int id;
+};
+
+/* run-length encoded sprite with 8 bit palette indices instead of colours: a quarter of the pixel memory of a
+   RleSprite, and colour variants are palette swaps sharing the same indices. Images with more than 255 colours
+   are reduced to 255 (median cut), keyColors always keep an exact entry of their own so they can be swapped.
+   Drawn with Graphics::DrawSprite( x, y, [srcRect,] IndexedSprite [, Palette] ) */
+class IndexedSprite
+{
+public:
+    struct Span
+    {
+        unsigned short x;           /* first pixel of the span in the row */
+        unsigned short length;
+        unsigned int offset;        /* index of the first pixel in the index buffer */
+    };
+public:
+    IndexedSprite( const Surface& s, Color chroma, const std::vector< Color >& keyColors = {} );
+    IndexedSprite( const Surface& s, const RectI& srcRect, Color chroma, const std::vector< Color >& keyColors = {} );
+
+    int GetWidth() const
+    {
+        return width;
+    }
+    int GetHeight() const
+    {
+        return height;
+    }
+    RectI GetRect() const
+    {
+        return{ 0, width, 0, height };
+    }
+    const Span* GetSpansBegin( int y ) const
+    {
+        return spans.data() + rowStarts[ y ];
+    }
+    const Span* GetSpansEnd( int y ) const
+    {
+        return spans.data() + rowStarts[ y + 1 ];
+    }
+    const unsigned char* GetIndices() const
+    {
+        return indices.data();
+    }
+    int GetNumOpaquePixels() const
+    {
+        return ( int )indices.size();
+    }
+    /* colours of the source image, the base of all palette swaps */
+    const Palette& GetPalette() const
+    {
+        return palette;
+    }
+    int GetNumSourceColors() const      /* distinct opaque colours before the reduction to the palette */
+    {
+        return nSourceColors;
+    }
+    size_t GetMemoryUsage() const       /* bytes of spans, indices and palette */
+    {
+        return spans.size() * sizeof( Span ) + rowStarts.size() * sizeof( int ) + indices.size() + sizeof( Palette );
+    }
+    unsigned int GetId() const
+    {
+        return id;
+    }
+private:
+    static unsigned int NextId();
+private:
+    unsigned int id;
+    int width;
+    int height;
+    int nSourceColors = 0;
+    Palette palette;
+    std::vector< Span > spans;
+    std::vector< int > rowStarts;       /* first span of every row, height + 1 entries */
+    std::vector< unsigned char > indices;   /* opaque pixels only */
+};
@@ -3,12 +3,35 @@
 #include <assert.h>
 #include <algorithm>
 
-Level::Level( const std::string& filename, const int actionBarWidth )
+Level::Level( const Surface& lvlImg, const int actionBarWidth )
     :
-    m_lvlImg( filename )
+    m_lvlImg( lvlImg )
 {
     m_actionBarWidth = actionBarWidth;
     init();
+
+    /* image pyramid for the zoom levels: every level averages 2x2 pixels of the previous one */
+    m_vPyramid.reserve( nZoomLevels - 1 );
+    for( int zoom = 1; zoom < nZoomLevels; ++zoom )
+    {
+        const Surface& src = getImage( zoom - 1 );
+        Surface dst( std::max( src.GetWidth() / 2, 1 ), std::max( src.GetHeight() / 2, 1 ) );
+        for( int y = 0; y < dst.GetHeight(); ++y )
+        {
+            const Color* pRow0 = src.GetRow( std::min( 2 * y, src.GetHeight() - 1 ) );
+            const Color* pRow1 = src.GetRow( std::min( 2 * y + 1, src.GetHeight() - 1 ) );
+            for( int x = 0; x < dst.GetWidth(); ++x )
+            {
+                const int x0 = std::min( 2 * x, src.GetWidth() - 1 );
+                const int x1 = std::min( 2 * x + 1, src.GetWidth() - 1 );
+                const int r = pRow0[ x0 ].GetR() + pRow0[ x1 ].GetR() + pRow1[ x0 ].GetR() + pRow1[ x1 ].GetR();
+                const int g = pRow0[ x0 ].GetG() + pRow0[ x1 ].GetG() + pRow1[ x0 ].GetG() + pRow1[ x1 ].GetG();
+                const int b = pRow0[ x0 ].GetB() + pRow0[ x1 ].GetB() + pRow1[ x0 ].GetB() + pRow1[ x1 ].GetB();
+                dst.PutPixel( x, y, Color( ( unsigned char )( ( r + 2 ) / 4 ), ( unsigned char )( ( g + 2 ) / 4 ), ( unsigned char )( ( b + 2 ) / 4 ) ) );
+            }
+        }
+        m_vPyramid.push_back( std::move( dst ) );
+    }
 }
 
 Level::~Level()
@@ -147,6 +170,7 @@ void Level::init()
     mp_content[ 288 ] = Tile::OBSTACLE;
 #endif
 
+    mp_gridOverlay.reset();     /* new content */
     m_bInitialized = true;
 }
 
@@ -163,25 +187,47 @@ Vec2 Level::getTileCenter( const int tileIdx ) const
 
 void Level::draw( Graphics& gfx, const Vei2& camera, const bool drawGrid ) const
 {
-    /* calculate RectI of the current visible map snippet */
-    const int xStart = std::max( camera.x - Graphics::halfScreenWidth, 0 );
-    const int yStart = std::max( camera.y - Graphics::halfScreenHeight, 0 );
-    const int xEnd = std::min( m_width, camera.x + Graphics::halfScreenWidth - m_actionBarWidth );
-    const int yEnd = std::min( m_height, camera.y + Graphics::halfScreenHeight );
+    /* calculate RectI of the current visible map snippet (zoomed coordinates, the level can be smaller than the view) */
+    const Surface& img = getImage( m_zoom );
+    const Vei2 offset = getViewOffset( camera ) / getZoomScale();
+    const int xStart = std::max( offset.x, 0 );
+    const int yStart = std::max( offset.y, 0 );
+    const int xEnd = std::min( img.GetWidth(), offset.x + Graphics::ScreenWidth - m_actionBarWidth );
+    const int yEnd = std::min( img.GetHeight(), offset.y + Graphics::ScreenHeight );
 
     RectI snippet = RectI( xStart, xEnd, yStart, yEnd );
 
 #if !_DEBUG
-    gfx.DrawSprite( 0, 0, snippet, m_lvlImg, SpriteEffect::Copy{} );
+    if( xStart < xEnd && yStart < yEnd )
+    {
+        gfx.DrawOpaque( xStart - offset.x, yStart - offset.y, snippet, img );
+    }
 #endif
 
-    /* tile grid */
-    if( drawGrid )
+    /* tile grid (1:1 only) */
+    if( drawGrid && m_zoom == 0 )
     {
         drawTileGrid( gfx, camera, false );
     }    
 }
 
+Vei2 Level::clampCamera( const Vei2& camPos ) const
+{
+    const int s = getZoomScale();
+    const Vei2 view( ( Graphics::ScreenWidth - m_actionBarWidth ) * s, Graphics::ScreenHeight * s );
+    Vei2 offset = getViewOffset( camPos );
+    const auto clampAxis = [ s ]( const int o, const int levelSize, const int viewSize )
+    {
+        /* larger than the level: centered */
+        const int clamped = levelSize >= viewSize ? std::min( std::max( o, 0 ), levelSize - viewSize ) : -( viewSize - levelSize ) / 2;
+        /* multiple of the zoom scale (rounded down), zoomed coordinates stay integers */
+        return clamped >= 0 ? clamped / s * s : -( ( -clamped + s - 1 ) / s * s );
+    };
+    offset.x = clampAxis( offset.x, m_width, view.x );
+    offset.y = clampAxis( offset.y, m_height, view.y );
+    return offset + Vei2( Graphics::halfScreenWidth, Graphics::halfScreenHeight ) * s;
+}
+
 void Level::drawTileGrid( Graphics& gfx, const Vei2& camera, const bool drawFreeTiles ) const
 {
     assert( m_height > 0 && m_width > 0 && m_tileSize > 0 );
@@ -189,31 +235,67 @@ void Level::drawTileGrid( Graphics& gfx, const Vei2& camera, const bool drawFree
     const int xOffset = camera.x - Graphics::halfScreenWidth;
     const int yOffset = camera.y - Graphics::halfScreenHeight;
 
-    for( int x = 0; x < m_widthInTiles; ++x )
+    /* obstacles: one clipped blit of the visible part (left of the action bar) of the baked overlay */
+    if( !mp_gridOverlay )
     {
-        int leftX = x * m_tileSize - xOffset;
-        if( leftX > Graphics::ScreenWidth - m_actionBarWidth )
+        bakeGridOverlay();
+    }
+    const RectI visible( std::max( xOffset, 0 ), std::min( mp_gridOverlay->GetWidth(), xOffset + Graphics::ScreenWidth - m_actionBarWidth ),
+                         std::max( yOffset, 0 ), std::min( mp_gridOverlay->GetHeight(), yOffset + Graphics::ScreenHeight ) );
+    if( visible.left < visible.right && visible.top < visible.bottom )
+    {
+        gfx.DrawSprite( visible.left - xOffset, visible.top - yOffset, visible, *mp_gridOverlay );
+    }
+
+    if( drawFreeTiles )
+    {
+        /* visible tiles only */
+        const int xEnd = std::min( m_widthInTiles, ( xOffset + Graphics::ScreenWidth - m_actionBarWidth ) / m_tileSize + 1 );
+        const int yEnd = std::min( m_heightInTiles, ( yOffset + Graphics::ScreenHeight ) / m_tileSize + 1 );
+        for( int x = std::max( xOffset / m_tileSize, 0 ); x < xEnd; ++x )
         {
-            continue;
+            for( int y = std::max( yOffset / m_tileSize, 0 ); y < yEnd; ++y )
+            {
+                if( Tile::EMPTY == mp_content[ y * m_widthInTiles + x ] )
+                {
+                    RectI tile( { x * m_tileSize - xOffset, y * m_tileSize - yOffset },
+                                { ( x + 1 ) * m_tileSize - 1 - xOffset, ( y + 1 ) * m_tileSize - 1 - yOffset } );
+                    gfx.DrawRectBorder( tile, 1, Colors::Green );
+                }
+            }
         }
-        for( int y = 0; y < m_heightInTiles; ++y )
-        {
-            RectI tile( { leftX, y * m_tileSize - yOffset },
-                        { ( x + 1 ) * m_tileSize - 1 - xOffset, ( y + 1 ) * m_tileSize - 1 - yOffset } );
+    }
+}
 
-            if( Tile::OBSTACLE == mp_content[ y * m_widthInTiles + x ] )
+void Level::bakeGridOverlay() const
+{
+    /* same pixels as DrawRectBorder( tile, 1 ) plus DrawLine( top left, bottom right ) per obstacle,
+       with tile = ( x * size, y * size ) .. ( ( x + 1 ) * size - 1, ( y + 1 ) * size - 1 ) */
+    const Color key = Colors::Black;
+    Surface overlay( m_widthInTiles * m_tileSize, m_heightInTiles * m_tileSize );
+    overlay.Fill( overlay.GetRect(), key );
+    for( int y = 0; y < m_heightInTiles; ++y )
+    {
+        for( int x = 0; x < m_widthInTiles; ++x )
+        {
+            if( Tile::OBSTACLE != mp_content[ y * m_widthInTiles + x ] )
             {
-                gfx.DrawRectBorder( tile, 1, Colors::Red );
-                Vei2 tl = { tile.left, tile.top };
-                Vei2 br = { tile.right, tile.bottom };
-                gfx.DrawLine( tl, br, Colors::Red );
+                continue;
             }
-            else if( drawFreeTiles )
+            const int left = x * m_tileSize;
+            const int top = y * m_tileSize;
+            const int last = m_tileSize - 2;   /* border: tile rect is one pixel smaller and exclusive */
+            overlay.Fill( RectI( left, left + last + 1, top, top + 1 ), Colors::Red );
+            overlay.Fill( RectI( left, left + last + 1, top + last, top + last + 1 ), Colors::Red );
+            overlay.Fill( RectI( left, left + 1, top, top + last + 1 ), Colors::Red );
+            overlay.Fill( RectI( left + last, left + last + 1, top, top + last + 1 ), Colors::Red );
+            for( int i = 0; i < m_tileSize; ++i )
             {
-                gfx.DrawRectBorder( tile, 1, Colors::Green );
+                overlay.PutPixel( left + i, top + i, Colors::Red );
             }
         }
     }
+    mp_gridOverlay = std::make_unique< RleSprite >( overlay, key );
 }
 
 void Level::drawPath( Graphics& gfx, const Vei2& camera, std::vector< int > vPath, const int currIdx, const int startIdx, const int targetIdx ) const
@@ -1,6 +1,7 @@
 #pragma once
 #include "Graphics.h"
 #include <vector>
+#include <memory>
 #include <assert.h>
 
 class PathFinder;
@@ -15,7 +16,7 @@ enum class Tile
 class Level
 {
 public:
-    Level( const std::string& filename, const int actionBarWidth );
+    Level( const Surface& lvlImg, const int actionBarWidth );      /* lvlImg has to outlive the level */
     ~Level();
 
     void init();
@@ -87,17 +88,79 @@ public:
     {
         return m_actionBarWidth;
     }
-    /* return RectF of the tile at mouse position in screen coordinates (not world coordinates!) */
-    RectF getTileRect( const Vec2& mousePos, const Vei2& camPos ) const
+    const Surface& getImage() const
     {
-        const Vei2 halfScreen( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
-        const Vei2 offset = camPos - halfScreen;
+        return m_lvlImg;
+    }
 
-        int tileIdx = getTileIdx( ( int )mousePos.x + offset.x, ( int )mousePos.y + offset.y );
+    /* zoom: level z shows 2^z level pixels per screen pixel (z = 0 is 1:1). Everything drawn in the world layer at a
+       zoom level uses zoomed coordinates (level pixels / 2^z), the camera offset is kept a multiple of 2^z */
+    static constexpr int nZoomLevels = 4;
+    void setZoom( const int zoom )
+    {
+        assert( zoom >= 0 && zoom < nZoomLevels );
+        m_zoom = zoom;
+    }
+    int getZoom() const
+    {
+        return m_zoom;
+    }
+    int getZoomScale() const
+    {
+        return 1 << m_zoom;
+    }
+    /* level image box filtered down to the zoom level, built at load time */
+    const Surface& getImage( const int zoom ) const
+    {
+        return zoom == 0 ? m_lvlImg : m_vPyramid[ zoom - 1 ];
+    }
+    /* camPos: level position of the screen center. Kept inside of the level (centered if the level is smaller than
+       the view) and snapped to the zoom scale */
+    Vei2 clampCamera( const Vei2& camPos ) const;
+    /* level position of the screen origin */
+    Vei2 getViewOffset( const Vei2& camPos ) const
+    {
+        return camPos - Vei2( Graphics::halfScreenWidth, Graphics::halfScreenHeight ) * getZoomScale();
+    }
+    /* part of the level shown left of the action bar (level pixels) */
+    RectI getViewRect( const Vei2& camPos ) const
+    {
+        return RectI( getViewOffset( camPos ), ( Graphics::ScreenWidth - m_actionBarWidth ) * getZoomScale(), Graphics::ScreenHeight * getZoomScale() );
+    }
+    Vec2 screenToWorld( const Vec2& screenPos, const Vei2& camPos ) const
+    {
+        const Vei2 offset = getViewOffset( camPos );
+        return Vec2( ( float )offset.x, ( float )offset.y ) + screenPos * ( float )getZoomScale();
+    }
+    Vec2 worldToScreen( const Vec2& p, const Vei2& camPos ) const
+    {
+        const Vei2 offset = getViewOffset( camPos );
+        const float s = ( float )getZoomScale();
+        return Vec2( ( p.x - offset.x ) / s, ( p.y - offset.y ) / s );
+    }
+    RectF worldToScreen( const RectF& r, const Vei2& camPos ) const
+    {
+        const Vei2 offset = getViewOffset( camPos );
+        const float s = ( float )getZoomScale();
+        return RectF( ( r.left - offset.x ) / s, ( r.right - offset.x ) / s, ( r.top - offset.y ) / s, ( r.bottom - offset.y ) / s );
+    }
+    /* true if draw() fills the whole screen left of the action bar (camera is clamped to the level) */
+    bool coversScreen() const
+    {
+#if _DEBUG
+        return false;   /* no level image in debug mode */
+#else
+        return m_bInitialized && m_width >= ( Graphics::ScreenWidth - m_actionBarWidth ) * getZoomScale() && m_height >= Graphics::ScreenHeight * getZoomScale();
+#endif
+    }
+    /* return RectF of the tile at mouse position in screen coordinates (not world coordinates!), current zoom level */
+    RectF getTileRect( const Vec2& mousePos, const Vei2& camPos ) const
+    {
+        int tileIdx = getTileIdx( screenToWorld( mousePos, camPos ) );
 
-        Vec2 topLeft = getTileCenter( tileIdx ) - Vec2( m_tileSize / 2.0f, m_tileSize / 2.0f ) - offset;
+        Vec2 topLeft = getTileCenter( tileIdx ) - Vec2( m_tileSize / 2.0f, m_tileSize / 2.0f );
         
-        return RectF( topLeft, ( float )m_tileSize, ( float )m_tileSize );
+        return worldToScreen( RectF( topLeft, ( float )m_tileSize, ( float )m_tileSize ), camPos );
     }
 private:
     bool m_bInitialized = false;
@@ -118,8 +181,15 @@ private:
     /* level content */
     Tile* mp_content = nullptr;
 
+    /* debug overlay of the obstacle tiles (red frame and cross) for the whole level, baked on first use and
+       dropped whenever mp_content changes (init()) */
+    void bakeGridOverlay() const;
+    mutable std::unique_ptr< RleSprite > mp_gridOverlay;
+
     /* level image */
-    Surface m_lvlImg;
+    const Surface& m_lvlImg;
+    std::vector< Surface > m_vPyramid;      /* 1/2, 1/4, ... of m_lvlImg (zoom levels 1 and up) */
+    int m_zoom = 0;
 
     /* action bar */
     int m_actionBarWidth;
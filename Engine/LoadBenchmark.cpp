@@ -0,0 +1,188 @@
+#include "LoadBenchmark.h"
+#include "Surface.h"
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#ifdef _WIN32
+#include "ChiliWin.h"
+#else
+#include <dirent.h>
+#endif
+
+namespace
+{
+    struct DirEntry
+    {
+        std::string name;
+        bool bIsDir;
+    };
+
+    /* entries of one directory without "." and "..", empty if it cannot be opened */
+#ifdef _WIN32
+    std::vector< DirEntry > listDirectory( const std::string& path )
+    {
+        std::vector< DirEntry > vEntries;
+        WIN32_FIND_DATAA data;
+        const HANDLE hFind = FindFirstFileA( ( path + "*" ).c_str(), &data );
+        if( hFind == INVALID_HANDLE_VALUE )
+        {
+            return vEntries;
+        }
+        do
+        {
+            const std::string name = data.cFileName;
+            if( name != "." && name != ".." )
+            {
+                vEntries.push_back( { name, ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) != 0 } );
+            }
+        }
+        while( FindNextFileA( hFind, &data ) );
+        FindClose( hFind );
+        return vEntries;
+    }
+#else
+    std::vector< DirEntry > listDirectory( const std::string& path )
+    {
+        std::vector< DirEntry > vEntries;
+        DIR* pDir = opendir( path.c_str() );
+        if( !pDir )
+        {
+            return vEntries;
+        }
+        while( const dirent* pEntry = readdir( pDir ) )
+        {
+            const std::string name = pEntry->d_name;
+            if( name != "." && name != ".." )
+            {
+                vEntries.push_back( { name, pEntry->d_type == DT_DIR } );
+            }
+        }
+        closedir( pDir );
+        return vEntries;
+    }
+#endif
+
+    /* relative paths of all .bmp files below dir */
+    void findBitmaps( const std::string& dir, const std::string& relDir, std::vector< std::string >& vFiles )
+    {
+        for( const auto& e : listDirectory( dir + "/" + relDir ) )
+        {
+            if( e.bIsDir )
+            {
+                findBitmaps( dir, relDir + e.name + "/", vFiles );
+            }
+            else if( e.name.size() > 4 && e.name.compare( e.name.size() - 4, 4, ".bmp" ) == 0 )
+            {
+                vFiles.push_back( relDir + e.name );
+            }
+        }
+    }
+
+    template< typename T >
+    T readValue( std::ifstream& file, const int offset )
+    {
+        T value;
+        file.seekg( offset );
+        file.read( reinterpret_cast< char* >( &value ), sizeof( value ) );
+        return value;
+    }
+
+    /* reference: the loader Surface used before, one file.get() per channel and PutPixel() per pixel */
+    Surface loadPerPixel( const std::string& filename )
+    {
+        std::ifstream file( filename, std::ios::binary );
+        const uint32_t offBits = readValue< uint32_t >( file, 10 );
+        const int32_t width = readValue< int32_t >( file, 18 );
+        const int32_t biHeight = readValue< int32_t >( file, 22 );
+        const bool is32b = readValue< uint16_t >( file, 28 ) == 32;
+        const int height = std::abs( biHeight );
+
+        Surface s( width, height );
+        file.seekg( offBits );
+        const int padding = ( 4 - ( width * 3 ) % 4 ) % 4;
+        for( int i = 0; i < height; i++ )
+        {
+            const int y = biHeight < 0 ? i : height - 1 - i;
+            for( int x = 0; x < width; x++ )
+            {
+                const int b = file.get();
+                const int g = file.get();
+                const int r = file.get();
+                s.PutPixel( x, y, Color( ( unsigned char )r, ( unsigned char )g, ( unsigned char )b ) );
+                if( is32b )
+                {
+                    file.seekg( 1, std::ios::cur );
+                }
+            }
+            if( !is32b )
+            {
+                file.seekg( padding, std::ios::cur );
+            }
+        }
+        return s;
+    }
+
+    bool isEqual( const Surface& a, const Surface& b )
+    {
+        if( a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight() )
+        {
+            return false;
+        }
+        for( int y = 0; y < a.GetHeight(); y++ )
+        {
+            if( !std::equal( a.GetRow( y ), a.GetRow( y ) + a.GetWidth(), b.GetRow( y ) ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* best of nRuns, in milliseconds */
+    template< typename F >
+    float measure( F load, const int nRuns )
+    {
+        float best = 1e9f;
+        for( int i = 0; i < nRuns; i++ )
+        {
+            const auto start = std::chrono::steady_clock::now();
+            load();
+            const std::chrono::duration< float, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min( best, elapsed.count() );
+        }
+        return best;
+    }
+}
+
+std::vector< std::string > LoadBenchmark::run( const std::string& imageDir )
+{
+    std::vector< std::string > vFiles;
+    findBitmaps( imageDir, "", vFiles );
+    std::sort( vFiles.begin(), vFiles.end() );
+
+    std::vector< std::string > vLines;
+    char buffer[ 160 ];
+    float totalBulk = 0.0f;
+    float totalPerPixel = 0.0f;
+    int nMismatches = 0;
+    for( const auto& f : vFiles )
+    {
+        const std::string path = imageDir + "/" + f;
+        const Surface bulk( path );
+        const bool bEqual = isEqual( bulk, loadPerPixel( path ) );
+        nMismatches += bEqual ? 0 : 1;
+
+        const float tBulk = measure( [&]() { Surface s( path ); }, 3 );
+        const float tPerPixel = measure( [&]() { loadPerPixel( path ); }, 3 );
+        totalBulk += tBulk;
+        totalPerPixel += tPerPixel;
+
+        snprintf( buffer, sizeof( buffer ), "%-28s %4dx%-4d %6.2f ms (per pixel %7.2f ms)%s", f.c_str(), bulk.GetWidth(), bulk.GetHeight(), tBulk, tPerPixel, bEqual ? "" : " DIFFERENT" );
+        vLines.push_back( buffer );
+    }
+    snprintf( buffer, sizeof( buffer ), "%d images: %.2f ms (per pixel %.2f ms, x%.1f), %d different", ( int )vFiles.size(), totalBulk, totalPerPixel, totalPerPixel / std::max( totalBulk, 1e-6f ), nMismatches );
+    vLines.push_back( buffer );
+    return vLines;
+}
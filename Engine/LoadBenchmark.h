@@ -0,0 +1,11 @@
+#pragma once
+#include <vector>
+#include <string>
+
+/* load times of all bitmaps below imageDir: bulk loader (Surface( filename )) compared to the former per pixel loader,
+   which read every pixel with three file.get() calls. Both have to produce identical surfaces */
+class LoadBenchmark
+{
+public:
+    static std::vector< std::string > run( const std::string& imageDir );
+};
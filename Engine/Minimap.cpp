@@ -0,0 +1,144 @@
+#include "Minimap.h"
+#include <algorithm>
+#include <cmath>
+
+Minimap::Minimap( const Surface& lvlImg, const RectI& screenRect )
+    :
+    m_base( 1, 1 ),
+    m_image( 1, 1 ),
+    m_scale( std::max( ( float )lvlImg.GetWidth() / screenRect.GetWidth(), ( float )lvlImg.GetHeight() / screenRect.GetHeight() ) )
+{
+    const int width  = std::min( screenRect.GetWidth(), ( int )ceil( lvlImg.GetWidth() / m_scale ) );
+    const int height = std::min( screenRect.GetHeight(), ( int )ceil( lvlImg.GetHeight() / m_scale ) );
+    m_pos = Vei2( screenRect.left + ( screenRect.GetWidth() - width ) / 2, screenRect.top + ( screenRect.GetHeight() - height ) / 2 );
+
+    /* box filter: every minimap pixel is the average of the level pixels it covers */
+    m_base = Surface( width, height );
+    for( int y = 0; y < height; ++y )
+    {
+        const int yBegin = std::min( ( int )( y * m_scale ), lvlImg.GetHeight() - 1 );
+        const int yEnd   = std::min( std::max( ( int )( ( y + 1 ) * m_scale ), yBegin + 1 ), lvlImg.GetHeight() );
+        for( int x = 0; x < width; ++x )
+        {
+            const int xBegin = std::min( ( int )( x * m_scale ), lvlImg.GetWidth() - 1 );
+            const int xEnd   = std::min( std::max( ( int )( ( x + 1 ) * m_scale ), xBegin + 1 ), lvlImg.GetWidth() );
+            unsigned int r = 0, g = 0, b = 0;
+            for( int sy = yBegin; sy < yEnd; ++sy )
+            {
+                const Color* pSrc = lvlImg.GetRow( sy );
+                for( int sx = xBegin; sx < xEnd; ++sx )
+                {
+                    r += pSrc[ sx ].GetR();
+                    g += pSrc[ sx ].GetG();
+                    b += pSrc[ sx ].GetB();
+                }
+            }
+            const unsigned int n = ( yEnd - yBegin ) * ( xEnd - xBegin );
+            m_base.PutPixel( x, y, Color( ( unsigned char )( r / n ), ( unsigned char )( g / n ), ( unsigned char )( b / n ) ) );
+        }
+    }
+    m_image = m_base;
+    m_widthInCells  = ( width + cellSize - 1 ) / cellSize;
+    m_heightInCells = ( height + cellSize - 1 ) / cellSize;
+}
+
+void Minimap::update( const std::vector< Unit* >& vpUnits, const VisibilityGrid& visibility )
+{
+    /* compact list of the occupied cells, one entry per unit */
+    m_vNewMarkers.clear();
+    for( const Unit* u : vpUnits )
+    {
+        if( u->isDestroyed() || ( u->getTeam() != Team::_A && !visibility.isVisible( Team::_A, u->getTileIdx() ) ) )
+        {
+            continue;
+        }
+        const Vec2 loc = u->getLocation();
+        const int xCell = std::min( std::max( ( int )( loc.x / m_scale ) / cellSize, 0 ), m_widthInCells - 1 );
+        const int yCell = std::min( std::max( ( int )( loc.y / m_scale ) / cellSize, 0 ), m_heightInCells - 1 );
+        m_vNewMarkers.push_back( { yCell * m_widthInCells + xCell, u->getTeam() } );
+    }
+    /* several units in one cell: the lowest team (the player's) is shown */
+    std::sort( m_vNewMarkers.begin(), m_vNewMarkers.end(), []( const Marker& a, const Marker& b )
+    {
+        return a.cell < b.cell || ( a.cell == b.cell && a.team < b.team );
+    } );
+    m_vNewMarkers.erase( std::unique( m_vNewMarkers.begin(), m_vNewMarkers.end(), []( const Marker& a, const Marker& b )
+    {
+        return a.cell == b.cell;
+    } ), m_vNewMarkers.end() );
+
+    /* both lists are sorted by cell: one merge pass finds the cells which changed */
+    m_nChangedCells = 0;
+    auto itOld = m_vMarkers.cbegin();
+    auto itNew = m_vNewMarkers.cbegin();
+    while( itOld != m_vMarkers.cend() || itNew != m_vNewMarkers.cend() )
+    {
+        if( itNew == m_vNewMarkers.cend() || ( itOld != m_vMarkers.cend() && itOld->cell < itNew->cell ) )
+        {
+            restoreCell( itOld->cell );
+            ++itOld;
+        }
+        else if( itOld == m_vMarkers.cend() || itNew->cell < itOld->cell )
+        {
+            paintCell( itNew->cell, itNew->team );
+            ++itNew;
+        }
+        else
+        {
+            if( itOld->team != itNew->team )
+            {
+                paintCell( itNew->cell, itNew->team );
+            }
+            ++itOld;
+            ++itNew;
+        }
+    }
+    if( m_nChangedCells > 0 )
+    {
+        m_version++;
+    }
+    m_vMarkers.swap( m_vNewMarkers );
+}
+
+void Minimap::draw( Graphics& gfx, const RectI& viewRect ) const
+{
+    gfx.DrawOpaque( m_pos.x, m_pos.y, m_image.GetRect(), m_image, m_version );
+
+    /* visible part of the level */
+    const RectI frame( m_pos.x + ( int )( viewRect.left / m_scale ), m_pos.x + ( int )ceil( viewRect.right / m_scale ),
+                       m_pos.y + ( int )( viewRect.top / m_scale ), m_pos.y + ( int )ceil( viewRect.bottom / m_scale ) );
+    gfx.DrawRectBorder( frame, 1, Colors::White );
+}
+
+Vei2 Minimap::toLevel( const Vei2& screenPos ) const
+{
+    const int x = std::min( std::max( screenPos.x - m_pos.x, 0 ), m_image.GetWidth() - 1 );
+    const int y = std::min( std::max( screenPos.y - m_pos.y, 0 ), m_image.GetHeight() - 1 );
+    return Vei2( ( int )( ( x + 0.5f ) * m_scale ), ( int )( ( y + 0.5f ) * m_scale ) );
+}
+
+RectI Minimap::getCellRect( const int cell ) const
+{
+    const int x = cell % m_widthInCells * cellSize;
+    const int y = cell / m_widthInCells * cellSize;
+    return RectI( x, std::min( x + cellSize, m_image.GetWidth() ), y, std::min( y + cellSize, m_image.GetHeight() ) );
+}
+
+void Minimap::paintCell( const int cell, const Team team )
+{
+    m_image.Fill( getCellRect( cell ), Unit::getTeamColor( team ) );
+    m_nChangedCells++;
+}
+
+void Minimap::restoreCell( const int cell )
+{
+    const RectI r = getCellRect( cell );
+    for( int y = r.top; y < r.bottom; ++y )
+    {
+        for( int x = r.left; x < r.right; ++x )
+        {
+            m_image.PutPixel( x, y, m_base.GetPixel( x, y ) );
+        }
+    }
+    m_nChangedCells++;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include "Graphics.h"
+#include "Surface.h"
+#include "Unit.h"
+#include "VisibilityGrid.h"
+
+/* downscaled level image with unit markers (drawn into the action bar). The level image is box filtered once, after
+   that a frame repaints only the marker cells which changed since the previous frame, so the cost depends on the
+   number of units and not on the map size */
+class Minimap
+{
+public:
+    /* screenRect: available area, the map keeps its aspect ratio and is centered in it */
+    Minimap( const Surface& lvlImg, const RectI& screenRect );
+
+    /* own units are always shown, enemies only where team _A can see them */
+    void update( const std::vector< Unit* >& vpUnits, const VisibilityGrid& visibility );
+    /* viewRect: visible part of the level (level pixels), shown as a frame */
+    void draw( Graphics& gfx, const RectI& viewRect ) const;
+
+    bool contains( const Vei2& screenPos ) const
+    {
+        return RectI( m_pos, m_image.GetWidth(), m_image.GetHeight() ).Contains( screenPos );
+    }
+    Vei2 toLevel( const Vei2& screenPos ) const;    /* level pixel under a screen position on the minimap */
+    int getChangedCellsLastFrame() const
+    {
+        return m_nChangedCells;
+    }
+private:
+    static constexpr int cellSize = 3;              /* minimap pixels per marker cell (width and height) */
+    struct Marker
+    {
+        int cell;
+        Team team;
+    };
+    void paintCell( const int cell, const Team team );
+    void restoreCell( const int cell );             /* base image again */
+    RectI getCellRect( const int cell ) const;
+
+    Surface m_base;                                 /* box filtered level image */
+    Surface m_image;                                /* m_base plus the current markers */
+    unsigned int m_version = 0;                     /* changes whenever m_image changes (dirty tracking) */
+    Vei2 m_pos;                                     /* screen position of m_image */
+    float m_scale;                                  /* level pixels per minimap pixel */
+    int m_widthInCells;
+    int m_heightInCells;
+    std::vector< Marker > m_vMarkers;               /* drawn markers, sorted by cell, at most one per cell */
+    std::vector< Marker > m_vNewMarkers;            /* markers of the current frame, kept to reuse its memory */
+    int m_nChangedCells = 0;
+};
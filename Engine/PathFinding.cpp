@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <climits>
 #include "PathFinding.h"
 
 PathFinder::PathFinder( const Level& lvl )
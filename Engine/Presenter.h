@@ -0,0 +1,11 @@
+#pragma once
+#include "Colors.h"
+
+/* shows the finished frame of Graphics (called by Graphics::EndFrame()), the rasteriser itself never depends on the output */
+class Presenter
+{
+public:
+    virtual ~Presenter() = default;
+    /* pFrame: width * height pixels, rows without padding. Only valid during the call */
+    virtual void Present( const Color* pFrame, int width, int height ) = 0;
+};
@@ -0,0 +1,203 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include "RectI.h"
+
+/* pixel rules of the filled primitives, independent of the target: Graphics draws them into the frame buffer, pre-rendered
+   sprites (GunSprites) into a Surface, so both give exactly the same pixels */
+namespace Raster
+{
+    /* rounds towards minus infinity (b > 0) */
+    inline long long FloorDiv( const long long a, const long long b )
+    {
+        return a >= 0 ? a / b : -( ( -a + b - 1 ) / b );
+    }
+
+    inline int OutCode( const int x, const int y, const RectI& clip )
+    {
+        return ( x < clip.left ? 1 : 0 ) | ( x >= clip.right ? 2 : 0 ) | ( y < clip.top ? 4 : 0 ) | ( y >= clip.bottom ? 8 : 0 );
+    }
+
+    /* integer Bresenham, calls plot( x, y ) for every pixel of the line inside of clip. Lines outside of the clip rect are
+       rejected by their Cohen-Sutherland out codes. Clipped lines start and end at the first and last step inside of
+       the clip rect, the steps are computed from the line equation, so the pixels do not depend on the clip rect
+       (bands of the BandRenderer fit together seamlessly) */
+    template< typename F >
+    void Line( const int x1, const int y1, const int x2, const int y2, const RectI& clip, F plot )
+    {
+        const int code1 = OutCode( x1, y1, clip );
+        const int code2 = OutCode( x2, y2, clip );
+        if( code1 & code2 )
+        {
+            return;
+        }
+        /* u: main direction (one pixel per step), v: the other one */
+        const bool bXMajor = abs( x2 - x1 ) >= abs( y2 - y1 );
+        const int u0  = bXMajor ? x1 : y1;
+        const int v0  = bXMajor ? y1 : x1;
+        const int du  = bXMajor ? x2 - x1 : y2 - y1;
+        const int dv  = bXMajor ? y2 - y1 : x2 - x1;
+        const int su  = du < 0 ? -1 : 1;
+        const int sv  = dv < 0 ? -1 : 1;
+        const int adu = abs( du );
+        const int adv = abs( dv );
+        const auto put = [ & ]( const int u, const int v )
+        {
+            bXMajor ? plot( u, v ) : plot( v, u );
+        };
+        if( adu == 0 )
+        {
+            put( u0, v0 );      /* both points are inside, the out codes would differ otherwise */
+            return;
+        }
+
+        /* step i: u = u0 + su * i, v = v0 + sv * k( i ) with k( i ) = ( 2 * i * adv + adu ) / ( 2 * adu ) */
+        long long iStart = 0;
+        long long iEnd = adu;
+        if( code1 | code2 )
+        {
+            const int uMin = bXMajor ? clip.left : clip.top;
+            const int uMax = ( bXMajor ? clip.right : clip.bottom ) - 1;
+            const int vMin = bXMajor ? clip.top : clip.left;
+            const int vMax = ( bXMajor ? clip.bottom : clip.right ) - 1;
+            iStart = std::max( iStart, ( long long )( su > 0 ? uMin - u0 : u0 - uMax ) );
+            iEnd   = std::min( iEnd,   ( long long )( su > 0 ? uMax - u0 : u0 - uMin ) );
+
+            const long long kMin = sv > 0 ? vMin - v0 : v0 - vMax;
+            const long long kMax = sv > 0 ? vMax - v0 : v0 - vMin;
+            if( adv == 0 )
+            {
+                if( kMin > 0 || kMax < 0 )
+                {
+                    return;
+                }
+            }
+            else
+            {
+                iStart = std::max( iStart, -FloorDiv( adu - 2LL * adu * kMin, 2LL * adv ) );
+                iEnd   = std::min( iEnd, FloorDiv( 2LL * adu * ( kMax + 1 ) - adu - 1, 2LL * adv ) );
+            }
+            if( iStart > iEnd )
+            {
+                return;
+            }
+        }
+
+        const long long num = 2LL * iStart * adv + adu;
+        int u = u0 + su * ( int )iStart;
+        int v = v0 + sv * ( int )( num / ( 2 * adu ) );
+        int err = ( int )( num % ( 2 * adu ) );
+        for( long long i = iStart; i <= iEnd; ++i )
+        {
+            put( u, v );
+            u += su;
+            err += 2 * adv;
+            if( err >= 2 * adu )
+            {
+                err -= 2 * adu;
+                v += sv;
+            }
+        }
+    }
+
+    /* thickness > 1: every step of the center line is a run of thickness pixels across the main direction,
+       fill( rect ) is called with every run clipped to clip (never empty) */
+    template< typename F >
+    void ThickLine( const int x1, const int y1, const int x2, const int y2, const int thickness, const RectI& clip, F fill )
+    {
+        const int before = thickness / 2;
+        const int after = thickness - 1 - before;
+        if( abs( x2 - x1 ) >= abs( y2 - y1 ) )
+        {
+            const RectI centerClip( clip.left, clip.right, clip.top - after, clip.bottom + before );
+            Line( x1, y1, x2, y2, centerClip, [ & ]( const int x, const int y )
+            {
+                const int yBegin = std::max( y - before, clip.top );
+                const int yEnd = std::min( y + after + 1, clip.bottom );
+                if( yBegin < yEnd )
+                {
+                    fill( RectI( x, x + 1, yBegin, yEnd ) );
+                }
+            } );
+        }
+        else
+        {
+            const RectI centerClip( clip.left - after, clip.right + before, clip.top, clip.bottom );
+            Line( x1, y1, x2, y2, centerClip, [ & ]( const int x, const int y )
+            {
+                const int xBegin = std::max( x - before, clip.left );
+                const int xEnd = std::min( x + after + 1, clip.right );
+                if( xBegin < xEnd )
+                {
+                    fill( RectI( xBegin, xEnd, y, y + 1 ) );
+                }
+            } );
+        }
+    }
+
+    /* half widths of the rows of filled circles ( index: distance to the center row ), for the common small radii */
+    inline const std::vector< std::vector< int > >& CircleSpans()
+    {
+        static const std::vector< std::vector< int > > spans = []()
+        {
+            std::vector< std::vector< int > > table( 64 );
+            for( int r = 1; r < ( int )table.size(); ++r )
+            {
+                for( int dy = 0; dy < r; ++dy )
+                {
+                    int w = r - 1;
+                    while( w * w + dy * dy > r * r )
+                    {
+                        --w;
+                    }
+                    table[ r ].push_back( w );
+                }
+            }
+            return table;
+        }();
+        return spans;
+    }
+
+    /* one span per row: all pixels with x_diff^2 + y_diff^2 <= radius^2 (and less than radius away in x/y),
+       fill( rect ) is called with every row span clipped to clip (never empty) */
+    template< typename F >
+    void Circle( const int x, const int y, const int radius, const RectI& clip, F fill )
+    {
+        if( radius <= 0 )
+        {
+            return;
+        }
+        const auto& spans = CircleSpans();
+        const int rad_sq = radius * radius;
+        const int yEnd = std::min( y + radius, clip.bottom );
+        for( int y_loop = std::max( y - radius + 1, clip.top ); y_loop < yEnd; y_loop++ )
+        {
+            const int y_diff = abs( y - y_loop );
+            int halfWidth;
+            if( radius < ( int )spans.size() )
+            {
+                halfWidth = spans[ radius ][ y_diff ];
+            }
+            else
+            {
+                halfWidth = std::min( ( int )sqrt( ( float )( rad_sq - y_diff * y_diff ) ), radius - 1 );
+                while( halfWidth * halfWidth + y_diff * y_diff > rad_sq )
+                {
+                    --halfWidth;
+                }
+                while( halfWidth + 1 < radius && ( halfWidth + 1 ) * ( halfWidth + 1 ) + y_diff * y_diff <= rad_sq )
+                {
+                    ++halfWidth;
+                }
+            }
+            const int xBegin = std::max( x - halfWidth, clip.left );
+            const int xEnd = std::min( x + halfWidth + 1, clip.right );
+            if( xBegin < xEnd )
+            {
+                fill( RectI( xBegin, xEnd, y_loop, y_loop + 1 ) );
+            }
+        }
+    }
+}
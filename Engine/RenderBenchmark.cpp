@@ -0,0 +1,373 @@
+#include "RenderBenchmark.h"
+#include "HeadlessPresenter.h"
+#include "Graphics.h"
+#include "BandRenderer.h"
+#include "SpriteEffect.h"
+#include <chrono>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <fstream>
+
+namespace
+{
+    constexpr int unitSize = 40;
+    constexpr int nUnits = 80;
+    constexpr int worldWidth = 1600;
+    constexpr int worldHeight = 1200;
+    constexpr Color chroma = Colors::Magenta;
+    constexpr Color teamKey = Colors::MakeRGB( 255, 242, 0 );
+
+    /* integer only, so the golden images do not depend on the floating point behaviour of the platform */
+    int triangle( const int t, const int amplitude )
+    {
+        const int phase = t % ( 2 * amplitude );
+        return phase < amplitude ? phase : 2 * amplitude - phase;
+    }
+
+    unsigned int hash( unsigned int i )
+    {
+        i = ( i ^ 61u ) ^ ( i >> 16 );
+        i *= 9u;
+        i ^= i >> 4;
+        i *= 0x27d4eb2du;
+        return i ^ ( i >> 15 );
+    }
+
+    Surface makeBackground()
+    {
+        Surface s( worldWidth, worldHeight );
+        for( int y = 0; y < worldHeight; y++ )
+        {
+            for( int x = 0; x < worldWidth; x++ )
+            {
+                const unsigned char checker = ( ( x / 32 + y / 32 ) & 1 ) ? 40 : 0;
+                s.PutPixel( x, y, Color( ( unsigned char )( 60 + x * 120 / worldWidth ), ( unsigned char )( 90 + checker ), ( unsigned char )( 40 + y * 120 / worldHeight ) ) );
+            }
+        }
+        return s;
+    }
+
+    /* 8 directions side by side: a round body with a team coloured stripe, a barrel towards the direction */
+    Surface makeUnitSheet()
+    {
+        static const int dirX[ 8 ] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+        static const int dirY[ 8 ] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+        Surface s( 8 * unitSize, unitSize );
+        s.Fill( s.GetRect(), chroma );
+        const int c = unitSize / 2;
+        for( int d = 0; d < 8; d++ )
+        {
+            const int x0 = d * unitSize;
+            for( int y = 0; y < unitSize; y++ )
+            {
+                for( int x = 0; x < unitSize; x++ )
+                {
+                    const int dx = x - c;
+                    const int dy = y - c;
+                    if( dx * dx + dy * dy < 13 * 13 )
+                    {
+                        s.PutPixel( x0 + x, y, abs( dx * dirY[ d ] - dy * dirX[ d ] ) < 3 ? teamKey : Color( ( unsigned char )( 80 + dx * 3 ), 80, ( unsigned char )( 80 + dy * 3 ) ) );
+                    }
+                }
+            }
+            for( int i = 10; i < 19; i++ )
+            {
+                s.Fill( RectI( x0 + c + dirX[ d ] * i - 1, x0 + c + dirX[ d ] * i + 2, c + dirY[ d ] * i - 1, c + dirY[ d ] * i + 2 ), Colors::Black );
+            }
+        }
+        return s;
+    }
+
+    /* camera and amount of movement of the script */
+    struct Script
+    {
+        const char* name;
+        bool bScrolling;        /* false: the camera stands still */
+        int movingEvery;        /* every n-th unit moves, the others stand still */
+    };
+    /* scrolling: the camera moves every frame and most units move (worst case for dirty tracking).
+       still: fixed camera with a few moving units and some shots, the common case while playing */
+    const Script scripts[] = { { "scrolling", true, 1 }, { "still", false, 8 } };
+
+    struct Scene
+    {
+        Scene()
+            :
+            background( makeBackground() ),
+            unitSheet( makeUnitSheet() ),
+            unitRle( unitSheet, chroma )
+        {}
+        Surface background;
+        Surface unitSheet;
+        RleSprite unitRle;
+    };
+
+    Vei2 cameraOffset( const Script& script, const int frame )
+    {
+        return script.bScrolling ? Vei2( triangle( frame * 5, worldWidth - Graphics::ScreenWidth ), triangle( frame * 3, worldHeight - Graphics::ScreenHeight ) )
+                                 : Vei2( 400, 300 );
+    }
+
+    /* one frame of the script, drawn like Game::ComposeFrame(): world layer relative to the camera, then the HUD */
+    void drawFrame( Graphics& gfx, BandRenderer& renderer, const Scene& scene, const Script& script, const int frame )
+    {
+        const Vei2 offset = cameraOffset( script, frame );
+        renderer.beginWorld( offset );
+        gfx.DrawOpaque( 0, 0, RectI( offset, Graphics::ScreenWidth, Graphics::ScreenHeight ), scene.background );
+
+        for( int i = 0; i < nUnits; i++ )
+        {
+            const unsigned int h = hash( i );
+            /* every third unit stands still, of the others every movingEvery-th one moves back and forth */
+            const bool bMoving = i % 3 != 0 && i % script.movingEvery == 0;
+            const int t = bMoving ? frame * ( 1 + h % 3 ) : 0;
+            const Vei2 world( int( h % worldWidth ) + ( bMoving ? triangle( t, 200 ) - 100 : 0 ), int( ( h >> 12 ) % worldHeight ) );
+            const Vei2 pos = world - offset;
+            const int dir = bMoving ? ( ( t / 200 ) % 2 == 0 ? 2 : 6 ) : int( h >> 24 ) % 8;
+            const RectI src( dir * unitSize, ( dir + 1 ) * unitSize, 0, unitSize );
+            const int x = pos.x - unitSize / 2;
+            const int y = pos.y - unitSize / 2;
+
+            switch( i % 4 )
+            {
+            case 0:
+                gfx.DrawSprite( x, y, src, scene.unitRle );
+                break;
+            case 1:
+                gfx.DrawSprite( x, y, src, scene.unitSheet, SpriteEffect::Chroma( chroma ) );
+                break;
+            case 2:
+                gfx.DrawSprite( x, y, src, scene.unitSheet, SpriteEffect::TeamColor( chroma, teamKey, Colors::Blue ) );
+                break;
+            default:
+                gfx.DrawSprite( x, y, src, scene.unitSheet, SpriteEffect::Ghost( chroma ) );
+                break;
+            }
+            if( i % 2 == 0 )
+            {
+                gfx.DrawThickLine( pos.x, pos.y, pos.x + ( dir == 6 ? -18 : 18 ), pos.y - 6, 5, Colors::Gray );
+            }
+            /* life bar */
+            const int life = 20 - int( ( h + frame / 8 ) % 20 );
+            gfx.DrawRect( x, y - 6, x + 2 * life, y - 2, life > 10 ? Colors::Green : Colors::Red );
+            gfx.DrawRectBorder( RectI( x - 1, x + unitSize + 1, y - 7, y - 1 ), 1, Colors::White );
+            if( i % 5 == 0 )
+            {
+                gfx.DrawCircleBorder( pos.x, pos.y, 24, Colors::Green );
+                gfx.DrawRectCorners( RectF( ( float )x, ( float )( x + unitSize ), ( float )y, ( float )( y + unitSize ) ), Colors::White );
+            }
+            /* shots */
+            if( i % 7 == 0 && ( frame + i ) % 6 < 3 )
+            {
+                /* targets within weapon range */
+                const unsigned int target = hash( i + 1000 );
+                const Vei2 impact = pos + Vei2( int( target % 240 ) - 120, int( ( target >> 12 ) % 240 ) - 120 );
+                gfx.DrawLine( pos, impact, Colors::Yellow );
+                gfx.DrawCircle( impact, 3 + ( frame + i ) % 6, Colors::Red );
+            }
+        }
+        renderer.endWorld();
+
+        /* HUD: button bar and a growing selection rect */
+        gfx.DrawRect( 0, Graphics::ScreenHeight - 80, Graphics::ScreenWidth, Graphics::ScreenHeight, Colors::Gray );
+        for( int b = 0; b < 8; b++ )
+        {
+            const RectI button( 20 + b * 70, 80 + b * 70, Graphics::ScreenHeight - 70, Graphics::ScreenHeight - 10 );
+            gfx.DrawRect( button, Colors::LightGray );
+            gfx.DrawRectBorder( button, 2, b == ( frame / 10 ) % 8 ? Colors::Green : Colors::Blue );
+        }
+        const int selSize = script.bScrolling ? triangle( frame * 4, 300 ) : 120;
+        gfx.DrawRectBorder( RectI( 200, 200 + selSize, 100, 100 + selSize / 2 ), 1, Colors::White );
+    }
+
+    void renderFrame( Graphics& gfx, BandRenderer& renderer, const Scene& scene, const Script& script, const int frame )
+    {
+        renderer.setCamera( cameraOffset( script, frame ) );
+        gfx.BeginFrame( !renderer.keepsFrame() );
+        if( renderer.needsRecording() )
+        {
+            gfx.BeginRecording( renderer );
+            drawFrame( gfx, renderer, scene, script, frame );
+            gfx.EndRecording();
+            renderer.render();
+        }
+        else
+        {
+            drawFrame( gfx, renderer, scene, script, frame );
+        }
+        gfx.EndFrame();
+    }
+
+    /* FNV-1a (64 bit) of the RGB values of a frame, the X byte is not part of the image */
+    unsigned long long checksum( const std::vector< Color >& frame )
+    {
+        unsigned long long h = 14695981039346656037ull;
+        for( const Color c : frame )
+        {
+            const unsigned int rgb = c.dword & 0xFFFFFFu;
+            for( int shift = 0; shift < 24; shift += 8 )
+            {
+                h ^= ( rgb >> shift ) & 0xFFu;
+                h *= 1099511628211ull;
+            }
+        }
+        return h;
+    }
+
+    /* golden file: one line per frame, "<script> <frame> <checksum in hex>" */
+    std::string goldenKey( const char* script, const int frame )
+    {
+        char buffer[ 64 ];
+        snprintf( buffer, sizeof( buffer ), "%s %03d", script, frame );
+        return buffer;
+    }
+    std::map< std::string, unsigned long long > loadGolden( const std::string& filename )
+    {
+        std::map< std::string, unsigned long long > golden;
+        std::ifstream file( filename );
+        std::string script;
+        int frame;
+        std::string hex;
+        while( file >> script >> frame >> hex )
+        {
+            golden[ goldenKey( script.c_str(), frame ) ] = std::stoull( hex, nullptr, 16 );
+        }
+        return golden;
+    }
+    bool saveGolden( const std::string& filename, const std::map< std::string, unsigned long long >& golden )
+    {
+        std::ofstream file( filename );
+        char buffer[ 32 ];
+        for( const auto& g : golden )
+        {
+            snprintf( buffer, sizeof( buffer ), "%016llx", g.second );
+            file << g.first << " " << buffer << "\n";
+        }
+        return ( bool )file;
+    }
+}
+
+std::vector< std::string > RenderBenchmark::run( const std::string& goldenDir, const int nFrames, const bool bRecord, int& nFailed )
+{
+    struct Mode
+    {
+        const char* name;
+        int nThreads;
+        bool bDirty;
+    };
+    static const Mode modes[] = { { "serial", 1, false }, { "bands", 4, false }, { "dirty", 1, true }, { "dirty_bands", 4, true } };
+
+    const Scene scene;
+    std::vector< std::string > vLines;
+    char buffer[ 256 ];
+    const std::string goldenFile = goldenDir + "/render_checksums.txt";
+    std::map< std::string, unsigned long long > golden = bRecord ? std::map< std::string, unsigned long long >() : loadGolden( goldenFile );
+    int nMissing = 0;
+    nFailed = 0;
+
+    for( const Script& script : scripts )
+    {
+        for( const Mode& mode : modes )
+        {
+            auto pHeadless = std::make_unique< HeadlessPresenter >();
+            HeadlessPresenter& presenter = *pHeadless;
+            Graphics gfx( std::move( pHeadless ) );
+            BandRenderer renderer( gfx, mode.nThreads );
+            renderer.setDirtyTracking( mode.bDirty );
+
+            /* correctness: every frame against its golden checksum. When recording, the serial renderer (it runs first)
+               is the reference for the other modes */
+            int nDiffFrames = 0;
+            for( int f = 0; f < nFrames; f++ )
+            {
+                renderFrame( gfx, renderer, scene, script, f );
+                const unsigned long long sum = checksum( presenter.GetFrame() );
+                const std::string key = goldenKey( script.name, f );
+                const auto it = golden.find( key );
+                if( it == golden.end() )
+                {
+                    if( bRecord )
+                    {
+                        golden[ key ] = sum;
+                    }
+                    else
+                    {
+                        nMissing++;
+                    }
+                }
+                else if( it->second != sum )
+                {
+                    nDiffFrames++;
+                    snprintf( buffer, sizeof( buffer ), "%s/%s_%s_%03d.png", goldenDir.c_str(), script.name, mode.name, f );
+                    presenter.SavePNG( buffer );
+                }
+            }
+            nFailed += nDiffFrames;
+
+            /* timing: the same frames again, without the present copy */
+            presenter.SetCopyFrame( false );
+            renderer.invalidate();
+            float dirtySum = 0.0f;
+            const auto start = std::chrono::steady_clock::now();
+            for( int f = 0; f < nFrames; f++ )
+            {
+                renderFrame( gfx, renderer, scene, script, f );
+                dirtySum += renderer.isDirtyTracking() ? renderer.getDirtyFraction() : 1.0f;
+            }
+            const std::chrono::duration< float, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+
+            snprintf( buffer, sizeof( buffer ), "%-10s %-12s %6.2f ms/frame, redrawn %3.0f%%, %d of %d frames differ", script.name, mode.name,
+                      elapsed.count() / std::max( nFrames, 1 ), dirtySum * 100.0f / std::max( nFrames, 1 ), nDiffFrames, nFrames );
+            vLines.push_back( buffer );
+        }
+    }
+    if( bRecord )
+    {
+        snprintf( buffer, sizeof( buffer ), "%s: %d golden checksums %s", goldenFile.c_str(), ( int )golden.size(), saveGolden( goldenFile, golden ) ? "recorded" : "NOT written" );
+        vLines.push_back( buffer );
+    }
+    else if( nMissing > 0 )
+    {
+        /* a missing golden checksum is an error, new frames or scripts have to be recorded on purpose */
+        snprintf( buffer, sizeof( buffer ), "error: %d frame checks without a golden checksum in %s (record with --record)", nMissing, goldenFile.c_str() );
+        vLines.push_back( buffer );
+        nFailed += nMissing;
+    }
+    return vLines;
+}
+
+#ifdef RENDER_BENCHMARK_MAIN
+#include <iostream>
+#include <cstring>
+
+int main( int argc, char* argv[] )
+{
+    std::vector< const char* > vArgs;
+    bool bRecord = false;
+    for( int i = 1; i < argc; i++ )
+    {
+        if( strcmp( argv[ i ], "--record" ) == 0 )
+        {
+            bRecord = true;
+        }
+        else
+        {
+            vArgs.push_back( argv[ i ] );
+        }
+    }
+    if( vArgs.empty() )
+    {
+        std::cerr << "usage: renderbench <golden dir> [frames] [--record]\n";
+        return 2;
+    }
+    int nFailed = 0;
+    for( const auto& l : RenderBenchmark::run( vArgs[ 0 ], vArgs.size() > 1 ? atoi( vArgs[ 1 ] ) : 120, bRecord, nFailed ) )
+    {
+        std::cout << l << "\n";
+    }
+    return nFailed > 0 ? 1 : 0;
+}
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+#include <vector>
+#include <string>
+
+/* replays a scripted scene through the CPU rasteriser (Graphics with a HeadlessPresenter, no window needed) and compares
+   every frame with a golden checksum. The scene only uses generated sprites, so it runs anywhere. It is rendered serially,
+   in parallel bands and with dirty tracking, every mode has to reproduce the golden frames.
+   Two scripts: a scrolling camera with most units moving, and a still camera with a few moving units.
+   The golden checksums are kept in ../golden/render_checksums.txt (120 frames per script).
+   Standalone build, e.g. on Linux:
+       g++ -std=c++14 -O2 -msse2 -pthread -DRENDER_BENCHMARK_MAIN RenderBenchmark.cpp HeadlessPresenter.cpp Graphics.cpp
+           BandRenderer.cpp Surface.cpp RleSprite.cpp RectI.cpp RectF.cpp Vec2.cpp Vei2.cpp -o renderbench
+       renderbench ../golden [frames]              (exit code 1 if a frame differs or has no golden checksum)
+       renderbench ../golden [frames] --record     (replaces the golden checksums with the ones of the serial renderer) */
+class RenderBenchmark
+{
+public:
+    /* goldenDir: existing directory with render_checksums.txt. A frame without a golden checksum is an error unless
+       bRecord is set, then the checksums of the serial renderer are written instead. Differing frames are written as
+       <script>_<mode>_000.png next to it. nFailed: differing and unchecked frames over all modes */
+    static std::vector< std::string > run( const std::string& goldenDir, const int nFrames, const bool bRecord, int& nFailed );
+};
@@ -0,0 +1,116 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include "Unit.h"
+#include "Cursor.h"
+#include "EffectPool.h"
+
+void RenderQueue::begin( const RectI& viewRect, const Vei2& camOffset, const bool bExtraInfos, const int zoom )
+{
+    m_vItems.clear();
+    m_viewRect      = viewRect;
+    m_camOffset     = camOffset;
+    m_zoom          = zoom;
+    m_bExtraInfos   = bExtraInfos && zoom == 0;
+    m_nCulled       = 0;
+    mp_effects      = nullptr;
+    mp_cursor       = nullptr;
+}
+
+void RenderQueue::addUnit( const Unit* pUnit, const bool bLifeBar )
+{
+    if( !pUnit->getDrawBounds( m_bExtraInfos ).IsOverlappingWith( m_viewRect ) )
+    {
+        m_nCulled++;
+        return;
+    }
+    const bool bGround = pUnit->isGroundUnit();
+    add( bGround ? Layer::GROUND : Layer::AIR, Kind::UNIT, pUnit );
+    if( bLifeBar && m_zoom == 0 )
+    {
+        add( bGround ? Layer::GROUND_UI : Layer::AIR_UI, Kind::LIFE_BAR, pUnit );
+    }
+}
+
+void RenderQueue::addEffects( const EffectPool& effects )
+{
+    assert( !mp_effects );  /* one pool per frame */
+    mp_effects = &effects;
+    for( const auto& e : effects.getEffects() )
+    {
+        if( !effects.isStarted( e ) )
+        {
+            continue;
+        }
+        if( !effects.getBounds( e ).IsOverlappingWith( m_viewRect ) )
+        {
+            m_nCulled++;
+            continue;
+        }
+        add( Layer::EFFECTS, Kind::EFFECT, &e );
+    }
+}
+
+void RenderQueue::addCursor( Cursor* pCursor, const bool bScrollingPressed, const bool bSelectingRectangle )
+{
+    assert( !mp_cursor );   /* one cursor per frame */
+    mp_cursor               = pCursor;
+    m_bScrollingPressed     = bScrollingPressed;
+    m_bSelectingRectangle   = bSelectingRectangle;
+    add( Layer::CURSOR, Kind::CURSOR, pCursor );
+}
+
+void RenderQueue::sort()
+{
+    std::sort( m_vItems.begin(), m_vItems.end(), []( const Item& a, const Item& b )
+    {
+        return a.layer != b.layer ? a.layer < b.layer : a.order < b.order;
+    } );
+}
+
+void RenderQueue::draw( Graphics& gfx, const Layer first, const Layer last ) const
+{
+    const int scale = 1 << m_zoom;
+    const Vei2 camPos = m_camOffset + Vei2( Graphics::halfScreenWidth, Graphics::halfScreenHeight ) * scale;
+    const Vei2 zoomedOffset = m_camOffset / scale;      /* the camera offset is a multiple of the scale */
+    const auto begin = std::lower_bound( m_vItems.begin(), m_vItems.end(), first, []( const Item& item, const Layer layer )
+    {
+        return item.layer < layer;
+    } );
+    for( auto it = begin; it != m_vItems.end() && it->layer <= last; ++it )
+    {
+        switch( it->kind )
+        {
+        case Kind::UNIT:
+            if( m_zoom > 0 )
+            {
+                static_cast< const Unit* >( it->pObject )->drawZoomed( gfx, zoomedOffset, m_zoom );
+            }
+            else
+            {
+                static_cast< const Unit* >( it->pObject )->draw( gfx, m_camOffset, m_bExtraInfos );
+            }
+            break;
+        case Kind::LIFE_BAR:
+            static_cast< const Unit* >( it->pObject )->drawLifeBar( gfx, m_camOffset );
+            break;
+        case Kind::EFFECT:
+            if( m_zoom > 0 )
+            {
+                mp_effects->drawZoomed( gfx, *static_cast< const EffectPool::Effect* >( it->pObject ), zoomedOffset, m_zoom );
+            }
+            else
+            {
+                mp_effects->draw( gfx, *static_cast< const EffectPool::Effect* >( it->pObject ), m_camOffset );
+            }
+            break;
+        case Kind::CURSOR:
+            mp_cursor->draw( camPos, m_bScrollingPressed, m_bSelectingRectangle );
+            break;
+        }
+    }
+}
+
+void RenderQueue::add( const Layer layer, const Kind kind, const void* pObject )
+{
+    m_vItems.push_back( { layer, ( unsigned int )m_vItems.size(), kind, pObject } );
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include "Graphics.h"
+#include "RectI.h"
+
+class Unit;
+class Cursor;
+class EffectPool;
+
+/* draw list of one frame: units and effects inside the view are collected once, tagged with their layer and sorted
+   back to front. Everything outside of the view is dropped while collecting and costs nothing to draw */
+class RenderQueue
+{
+public:
+    enum class Layer        /* drawing order */
+    {
+        GROUND = 0,
+        GROUND_UI,          /* life bars of the ground units */
+        AIR,
+        AIR_UI,
+        EFFECTS,
+        CURSOR
+    };
+
+    /* clears the queue, viewRect: visible part of the level (world coordinates), camOffset: world position of the screen origin,
+       zoom: Level zoom level, units and effects are drawn pre-scaled and without life bars and extra infos when zoomed out */
+    void begin( const RectI& viewRect, const Vei2& camOffset, const bool bExtraInfos, const int zoom = 0 );
+    void addUnit( const Unit* pUnit, const bool bLifeBar );
+    void addEffects( const EffectPool& effects );   /* the running effects of the pool, it must not change until the queue is drawn */
+    void addCursor( Cursor* pCursor, const bool bScrollingPressed, const bool bSelectingRectangle );
+    void sort();
+
+    /* draws the layers first..last, the queue has to be sorted */
+    void draw( Graphics& gfx, const Layer first, const Layer last ) const;
+
+    int getNumQueued() const
+    {
+        return ( int )m_vItems.size();
+    }
+    int getNumCulled() const
+    {
+        return m_nCulled;
+    }
+private:
+    enum class Kind
+    {
+        UNIT = 0,
+        LIFE_BAR,
+        EFFECT,
+        CURSOR
+    };
+    struct Item
+    {
+        Layer layer;
+        unsigned int order;         /* submission order, kept inside of a layer */
+        Kind kind;
+        const void* pObject;
+    };
+    void add( const Layer layer, const Kind kind, const void* pObject );
+
+    std::vector< Item > m_vItems;
+    RectI m_viewRect;
+    Vei2 m_camOffset;
+    bool m_bExtraInfos = false;
+    int m_zoom = 0;
+    int m_nCulled = 0;
+
+    const EffectPool* mp_effects = nullptr;
+    Cursor* mp_cursor = nullptr;
+    bool m_bScrollingPressed = false;
+    bool m_bSelectingRectangle = false;
+};
@@ -0,0 +1,61 @@
+#include "RleSprite.h"
+#include <cassert>
+#include <atomic>
+
+RleSprite::RleSprite( const Surface& s, Color chroma )
+    :
+    RleSprite( s, s.GetRect(), chroma )
+{
+}
+
+RleSprite::RleSprite( const Surface& s, const RectI& srcRect, Color chroma )
+    :
+    id( NextId() ),
+    width( srcRect.GetWidth() ),
+    height( srcRect.GetHeight() )
+{
+    assert( width <= 0xffff );
+    assert( srcRect.IsContainedBy( s.GetRect() ) );
+    rowStarts.reserve( height + 1 );
+
+    for( int y = 0; y < height; y++ )
+    {
+        rowStarts.push_back( ( int )spans.size() );
+
+        const Color* pRow = s.GetRow( srcRect.top + y ) + srcRect.left;
+        int x = 0;
+        while( x < width )
+        {
+            /* skip transparent pixels */
+            while( x < width && pRow[ x ] == chroma )
+            {
+                x++;
+            }
+            if( x == width )
+            {
+                break;
+            }
+            /* opaque run */
+            Span span;
+            span.x      = ( unsigned short )x;
+            span.offset = ( unsigned int )pixels.size();
+            while( x < width && pRow[ x ] != chroma )
+            {
+                pixels.push_back( pRow[ x ] );
+                x++;
+            }
+            span.length = ( unsigned short )( x - span.x );
+            spans.push_back( span );
+        }
+    }
+    rowStarts.push_back( ( int )spans.size() );
+
+    spans.shrink_to_fit();
+    pixels.shrink_to_fit();
+}
+
+unsigned int RleSprite::NextId()
+{
+    static std::atomic< unsigned int > nextId( 1 );
+    return nextId++;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include "Surface.h"
+#include "Colors.h"
+#include "RectI.h"
+
+/* run-length encoded sprite: every row is stored as spans of opaque (non chroma) pixels, transparent pixels are
+   skipped completely. Drawn with Graphics::DrawSprite( x, y, [srcRect,] RleSprite ) */
+class RleSprite
+{
+public:
+    struct Span
+    {
+        unsigned short x;           /* first pixel of the span in the row */
+        unsigned short length;
+        unsigned int offset;        /* index of the first pixel in the pixel buffer */
+    };
+public:
+    RleSprite( const Surface& s, Color chroma );
+    RleSprite( const Surface& s, const RectI& srcRect, Color chroma );     /* only srcRect of s, e.g. a sprite atlas region */
+
+    int GetWidth() const
+    {
+        return width;
+    }
+    int GetHeight() const
+    {
+        return height;
+    }
+    RectI GetRect() const
+    {
+        return{ 0, width, 0, height };
+    }
+    /* spans of row y, ordered by x */
+    const Span* GetSpansBegin( int y ) const
+    {
+        return spans.data() + rowStarts[ y ];
+    }
+    const Span* GetSpansEnd( int y ) const
+    {
+        return spans.data() + rowStarts[ y + 1 ];
+    }
+    const Color* GetPixels() const
+    {
+        return pixels.data();
+    }
+    int GetNumOpaquePixels() const
+    {
+        return ( int )pixels.size();
+    }
+    size_t GetMemoryUsage() const       /* bytes of spans and pixels */
+    {
+        return spans.size() * sizeof( Span ) + rowStarts.size() * sizeof( int ) + pixels.size() * sizeof( Color );
+    }
+    /* unique for every encoded image (copies share it), the frame diffing of the BandRenderer relies on it
+       because a new sprite may get the address of a deleted one */
+    unsigned int GetId() const
+    {
+        return id;
+    }
+private:
+    static unsigned int NextId();
+private:
+    unsigned int id;
+    int width;
+    int height;
+    std::vector< Span > spans;
+    std::vector< int > rowStarts;       /* first span of every row, height + 1 entries */
+    std::vector< Color > pixels;        /* opaque pixels only */
+};
@@ -0,0 +1,60 @@
+#include "SimulationLod.h"
+#include "Unit.h"
+
+SimulationLod::SimulationLod( const int reducedRate, const int margin )
+    :
+    m_reducedRate( reducedRate ),
+    m_margin( margin )
+{
+    assert( reducedRate >= 1 && margin >= 0 );
+}
+
+void SimulationLod::update( const std::vector< Unit* >& vpUnits, const RectI& viewRect, const float dt )
+{
+    m_nReduced = 0;
+    RectI view = viewRect.GetExpanded( m_margin );
+
+    for( const auto u : vpUnits )
+    {
+        if( view.Contains( u->getLocation() ) )
+        {
+            if( u->m_bFullDetail )
+            {
+                u->update( dt );
+            }
+            else
+            {
+                /* back in view -> catch up on the pending time and restore the cosmetic state */
+                const float pendingDt   = u->m_lodDt + dt;
+                const int pendingFrames = u->m_lodFrames + 1;
+                u->m_bFullDetail        = true;
+                u->m_lodDt              = 0.0f;
+                u->m_lodFrames          = 0;
+                u->updateCosmetics();
+                u->update( pendingDt, pendingFrames );
+            }
+        }
+        else
+        {
+            if( u->m_bFullDetail )
+            {
+                u->m_bFullDetail    = false;
+                u->m_lodDt          = 0.0f;
+                u->m_lodFrames      = 0;
+                u->m_lodCountdown   = 1 + m_nextPhase++ % m_reducedRate;
+            }
+
+            /* the first reduced update may come early (phase), it covers only the frames accumulated until then */
+            u->m_lodDt += dt;
+            u->m_lodFrames++;
+            if( --u->m_lodCountdown == 0 )
+            {
+                u->update( u->m_lodDt, u->m_lodFrames );
+                u->m_lodDt          = 0.0f;
+                u->m_lodFrames      = 0;
+                u->m_lodCountdown   = m_reducedRate;
+            }
+            m_nReduced++;
+        }
+    }
+}
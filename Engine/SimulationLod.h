@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include "RectI.h"
+
+class Unit;
+
+/* simulation level of detail: units inside the view (plus a margin) are updated every frame, all other units
+   only every m_reducedRate-th frame with the accumulated dt and without cosmetic work (sprite direction,
+   cannon orientation, effect timers) */
+class SimulationLod
+{
+public:
+    SimulationLod( const int reducedRate = 4, const int margin = 100 );
+
+    void update( const std::vector< Unit* >& vpUnits, const RectI& viewRect /* world coordinates */, const float dt );
+
+    int getNumReduced() const
+    {
+        return m_nReduced;
+    }
+private:
+    int m_reducedRate;          /* off-screen units are updated every n-th frame */
+    int m_margin;               /* in pixels around the view */
+    int m_nextPhase = 0;        /* spreads the reduced updates evenly over the frames */
+    int m_nReduced = 0;
+};
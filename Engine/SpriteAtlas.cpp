@@ -0,0 +1,367 @@
+#include "SpriteAtlas.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    /* top edge of the packed area, segment i covers x .. x + width */
+    struct SkylineSegment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    class Skyline
+    {
+    public:
+        Skyline( const int width, const int height )
+            :
+            m_width( width ),
+            m_height( height ),
+            m_vSegments( { { 0, 0, width } } )
+        {}
+        /* bottom-left rule: lowest top edge, then leftmost. Returns false if the rect does not fit anymore */
+        bool insert( const int w, const int h, Vei2& pos )
+        {
+            int bestIdx = -1;
+            int bestTop = m_height + 1;
+            for( int i = 0; i < ( int )m_vSegments.size() && m_vSegments[ i ].x + w <= m_width; ++i )
+            {
+                const int y = fit( i, w );
+                if( y + h <= m_height && y + h < bestTop )
+                {
+                    bestTop = y + h;
+                    bestIdx = i;
+                    pos = { m_vSegments[ i ].x, y };
+                }
+            }
+            if( bestIdx < 0 )
+            {
+                return false;
+            }
+            place( bestIdx, pos.x, pos.y + h, w );
+            return true;
+        }
+    private:
+        /* lowest y at which a rect of width w starting at segment i is above all segments below it */
+        int fit( int i, const int w ) const
+        {
+            int y = 0;
+            for( int remaining = w; remaining > 0; ++i )
+            {
+                y = std::max( y, m_vSegments[ i ].y );
+                remaining -= m_vSegments[ i ].width;
+            }
+            return y;
+        }
+        void place( const int i, const int x, const int top, const int w )
+        {
+            m_vSegments.insert( m_vSegments.begin() + i, { x, top, w } );
+            /* cut the segments now covered by the new one */
+            const int right = x + w;
+            for( int j = i + 1; j < ( int )m_vSegments.size() && m_vSegments[ j ].x < right; )
+            {
+                const int shrink = right - m_vSegments[ j ].x;
+                m_vSegments[ j ].x += shrink;
+                m_vSegments[ j ].width -= shrink;
+                if( m_vSegments[ j ].width > 0 )
+                {
+                    break;
+                }
+                m_vSegments.erase( m_vSegments.begin() + j );
+            }
+            /* merge neighbours of the same height */
+            for( int j = 0; j + 1 < ( int )m_vSegments.size(); )
+            {
+                if( m_vSegments[ j ].y == m_vSegments[ j + 1 ].y )
+                {
+                    m_vSegments[ j ].width += m_vSegments[ j + 1 ].width;
+                    m_vSegments.erase( m_vSegments.begin() + j + 1 );
+                }
+                else
+                {
+                    ++j;
+                }
+            }
+        }
+
+        int m_width;
+        int m_height;
+        std::vector< SkylineSegment > m_vSegments;
+    };
+
+    void putLittleEndian( std::ofstream& file, const unsigned int value, const int nBytes )
+    {
+        for( int i = 0; i < nBytes; ++i )
+        {
+            file.put( ( char )( ( value >> ( 8 * i ) ) & 0xFFu ) );
+        }
+    }
+
+    /* 24 bit, bottom-up rows (loaded again by Surface( filename )) */
+    bool writeBmp( const std::string& filename, const Surface& s )
+    {
+        std::ofstream file( filename, std::ios::binary );
+        if( !file )
+        {
+            return false;
+        }
+        const int pitch = ( s.GetWidth() * 3 + 3 ) & ~3;
+        const unsigned int imageSize = pitch * s.GetHeight();
+        file.put( 'B' );
+        file.put( 'M' );
+        putLittleEndian( file, 54 + imageSize, 4 );
+        putLittleEndian( file, 0, 4 );
+        putLittleEndian( file, 54, 4 );                  /* pixel data offset */
+        putLittleEndian( file, 40, 4 );                  /* info header size */
+        putLittleEndian( file, s.GetWidth(), 4 );
+        putLittleEndian( file, s.GetHeight(), 4 );
+        putLittleEndian( file, 1, 2 );                   /* planes */
+        putLittleEndian( file, 24, 2 );                  /* bits per pixel */
+        putLittleEndian( file, 0, 4 );                   /* uncompressed */
+        putLittleEndian( file, imageSize, 4 );
+        putLittleEndian( file, 0, 16 );                  /* resolution and palette, unused */
+
+        std::vector< char > row( pitch, 0 );
+        for( int y = s.GetHeight() - 1; y >= 0; --y )
+        {
+            const Color* pSrc = s.GetRow( y );
+            for( int x = 0; x < s.GetWidth(); ++x )
+            {
+                row[ x * 3 ]     = ( char )pSrc[ x ].GetB();
+                row[ x * 3 + 1 ] = ( char )pSrc[ x ].GetG();
+                row[ x * 3 + 2 ] = ( char )pSrc[ x ].GetR();
+            }
+            file.write( row.data(), pitch );
+        }
+        return bool( file );
+    }
+}
+
+SpriteAtlas::SpriteAtlas( const int pageSize )
+    :
+    m_pageSize( pageSize )
+{
+    assert( pageSize > 0 );
+}
+
+void SpriteAtlas::add( const std::string& name, Surface image, const unsigned long long stamp )
+{
+    assert( m_pages.empty() );      /* no adding after build() */
+    assert( !image.HasAlpha() );    /* pages are opaque (24 bit page files), alpha sprites use Surface::Premultiplied() */
+    m_vPending.push_back( { name, std::move( image ), stamp } );
+}
+
+void SpriteAtlas::build()
+{
+    assert( m_pages.empty() );
+
+    /* tall images first, that keeps the skyline flat */
+    std::vector< int > vOrder( m_vPending.size() );
+    for( int i = 0; i < ( int )vOrder.size(); ++i )
+    {
+        vOrder[ i ] = i;
+    }
+    std::sort( vOrder.begin(), vOrder.end(), [ this ]( const int a, const int b )
+    {
+        const Surface& sa = m_vPending[ a ].image;
+        const Surface& sb = m_vPending[ b ].image;
+        if( sa.GetHeight() != sb.GetHeight() )
+        {
+            return sa.GetHeight() > sb.GetHeight();
+        }
+        if( sa.GetWidth() != sb.GetWidth() )
+        {
+            return sa.GetWidth() > sb.GetWidth();
+        }
+        return m_vPending[ a ].name < m_vPending[ b ].name;
+    } );
+
+    /* positions first, the pages are allocated once their size is known */
+    std::vector< Skyline > vSkylines;
+    std::vector< Vei2 > vPageSizes;
+    std::vector< Vei2 > vPositions( m_vPending.size() );
+    std::vector< int > vPageOf( m_vPending.size() );
+    for( const int i : vOrder )
+    {
+        const int w = m_vPending[ i ].image.GetWidth();
+        const int h = m_vPending[ i ].image.GetHeight();
+        int page = 0;
+        for( ; page < ( int )vSkylines.size(); ++page )
+        {
+            if( vSkylines[ page ].insert( w, h, vPositions[ i ] ) )
+            {
+                break;
+            }
+        }
+        if( page == ( int )vSkylines.size() )
+        {
+            /* images larger than a page get a page of their own size */
+            vSkylines.emplace_back( std::max( w, m_pageSize ), std::max( h, m_pageSize ) );
+            vPageSizes.emplace_back( 0, 0 );
+            const bool bFits = vSkylines.back().insert( w, h, vPositions[ i ] );
+            assert( bFits );
+        }
+        vPageOf[ i ] = page;
+        vPageSizes[ page ].x = std::max( vPageSizes[ page ].x, vPositions[ i ].x + w );
+        vPageSizes[ page ].y = std::max( vPageSizes[ page ].y, vPositions[ i ].y + h );
+    }
+
+    m_pages.reserve( vPageSizes.size() );
+    for( const auto& size : vPageSizes )
+    {
+        m_pages.emplace_back( size.x, size.y );
+        m_pages.back().Fill( m_pages.back().GetRect(), Colors::Black );
+    }
+    for( int i = 0; i < ( int )m_vPending.size(); ++i )
+    {
+        const Surface& image = m_vPending[ i ].image;
+        Surface& page = m_pages[ vPageOf[ i ] ];
+        for( int y = 0; y < image.GetHeight(); ++y )
+        {
+            const Color* pSrc = image.GetRow( y );
+            for( int x = 0; x < image.GetWidth(); ++x )
+            {
+                page.PutPixel( vPositions[ i ].x + x, vPositions[ i ].y + y, pSrc[ x ] );
+            }
+        }
+        Entry& e = m_entries[ m_vPending[ i ].name ];
+        e.page = vPageOf[ i ];
+        e.stamp = m_vPending[ i ].stamp;
+        e.region = Region( page, RectI( vPositions[ i ], image.GetWidth(), image.GetHeight() ) );
+    }
+    m_vPending.clear();
+    m_vPending.shrink_to_fit();
+}
+
+std::string SpriteAtlas::pageFile( const std::string& indexFile, const int page ) const
+{
+    const size_t dot = indexFile.find_last_of( '.' );
+    const size_t slash = indexFile.find_last_of( "/\\" );
+    const std::string base = ( dot != std::string::npos && ( slash == std::string::npos || dot > slash ) ) ? indexFile.substr( 0, dot ) : indexFile;
+    return base + "_" + std::to_string( page ) + ".bmp";
+}
+
+bool SpriteAtlas::save( const std::string& indexFile ) const
+{
+    std::ofstream file( indexFile );
+    if( !file )
+    {
+        return false;
+    }
+    file << "spriteatlas 1\n" << "pages " << m_pages.size() << "\n";
+    /* sorted, the same atlas always gives the same index */
+    std::vector< std::string > vNames;
+    for( const auto& e : m_entries )
+    {
+        vNames.push_back( e.first );
+    }
+    std::sort( vNames.begin(), vNames.end() );
+    for( const auto& name : vNames )
+    {
+        const Entry& e = m_entries.at( name );
+        const RectI& r = e.region.rect;
+        file << "sprite " << e.page << " " << r.left << " " << r.top << " " << r.GetWidth() << " " << r.GetHeight() << " "
+             << e.stamp << " " << name << "\n";
+    }
+    bool bOk = bool( file );
+    for( int page = 0; page < ( int )m_pages.size(); ++page )
+    {
+        bOk = writeBmp( pageFile( indexFile, page ), m_pages[ page ] ) && bOk;
+    }
+    return bOk;
+}
+
+bool SpriteAtlas::load( const std::string& indexFile, const std::vector< std::string >& vNames, const std::vector< unsigned long long >& vStamps )
+{
+    assert( m_pages.empty() && m_vPending.empty() );
+    assert( vNames.size() == vStamps.size() );
+
+    std::ifstream file( indexFile );
+    std::string word;
+    int version = 0;
+    int nPages = 0;
+    if( !( file >> word >> version ) || word != "spriteatlas" || version != 1 || !( file >> word >> nPages ) || word != "pages" )
+    {
+        return false;
+    }
+    std::unordered_map< std::string, Entry > entries;
+    RectI r;
+    int page, width, height;
+    unsigned long long stamp;
+    while( file >> word >> page >> r.left >> r.top >> width >> height >> stamp )
+    {
+        std::string name;
+        std::getline( file >> std::ws, name );
+        if( word != "sprite" || page < 0 || page >= nPages )
+        {
+            return false;
+        }
+        r.right = r.left + width;
+        r.bottom = r.top + height;
+        Entry& e = entries[ name ];
+        e.page = page;
+        e.stamp = stamp;
+        e.region.rect = r;
+    }
+    /* exactly the requested images in their current version */
+    if( entries.size() != vNames.size() )
+    {
+        return false;
+    }
+    for( size_t i = 0; i < vNames.size(); ++i )
+    {
+        const auto it = entries.find( vNames[ i ] );
+        if( it == entries.end() || it->second.stamp != vStamps[ i ] )
+        {
+            return false;
+        }
+    }
+
+    std::vector< Surface > pages;
+    pages.reserve( nPages );
+    for( int i = 0; i < nPages; ++i )
+    {
+        const std::string filename = pageFile( indexFile, i );
+        if( !std::ifstream( filename ) )
+        {
+            return false;
+        }
+        pages.emplace_back( filename );
+    }
+    for( auto& e : entries )
+    {
+        if( !e.second.region.rect.IsContainedBy( pages[ e.second.page ].GetRect() ) )
+        {
+            return false;
+        }
+    }
+
+    m_pages = std::move( pages );
+    for( auto& e : entries )
+    {
+        e.second.region.pPage = &m_pages[ e.second.page ];
+    }
+    m_entries = std::move( entries );
+    return true;
+}
+
+const SpriteAtlas::Region& SpriteAtlas::get( const std::string& name ) const
+{
+    const auto it = m_entries.find( name );
+    assert( it != m_entries.end() );
+    return it->second.region;
+}
+
+size_t SpriteAtlas::getMemoryUsage() const
+{
+    size_t bytes = 0;
+    for( const auto& p : m_pages )
+    {
+        bytes += sizeof( Color ) * p.GetWidth() * p.GetHeight();
+    }
+    return bytes;
+}
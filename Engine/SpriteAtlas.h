@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Surface.h"
+#include "RleSprite.h"
+#include "IndexedSprite.h"
+#include "RectI.h"
+
+/* packs many small images into a few large pages (skyline bottom-left rectangle packing), so drawing touches fewer
+   pixel buffers and loading needs fewer allocations. The packed pages can be written to disk together with an index
+   and loaded again instead of the single images */
+class SpriteAtlas
+{
+public:
+    /* image inside of a page, usable with the srcRect versions of Graphics::DrawSprite() */
+    struct Region
+    {
+        Region() = default;
+        Region( const Surface& s )                  /* whole surface */
+            :
+            pPage( &s ),
+            rect( s.GetRect() )
+        {}
+        Region( const Surface& s, const RectI& r )
+            :
+            pPage( &s ),
+            rect( r )
+        {}
+        int getWidth() const
+        {
+            return rect.GetWidth();
+        }
+        int getHeight() const
+        {
+            return rect.GetHeight();
+        }
+        RleSprite makeRle( const Color chroma ) const
+        {
+            return RleSprite( *pPage, rect, chroma );
+        }
+        IndexedSprite makeIndexed( const Color chroma, const std::vector< Color >& keyColors = {} ) const
+        {
+            return IndexedSprite( *pPage, rect, chroma, keyColors );
+        }
+
+        const Surface* pPage = nullptr;
+        RectI rect;
+    };
+public:
+    SpriteAtlas( const int pageSize = 1024 );      /* maximum width and height of a page */
+    SpriteAtlas( const SpriteAtlas& ) = delete;
+    SpriteAtlas& operator=( const SpriteAtlas& ) = delete;
+
+    /* stamp: identifies the version of the source (e.g. a hash of its file), checked by load().
+       image has to be opaque (no Surface::HasAlpha()): the pages are saved as 24 bit bitmaps */
+    void add( const std::string& name, Surface image, const unsigned long long stamp = 0 );
+    void build();                                   /* packs all added images, they are freed afterwards */
+
+    /* index file plus one bmp per page next to it (<index name>_<page>.bmp) */
+    bool save( const std::string& indexFile ) const;
+    /* false (atlas left empty) if the index is missing or does not list exactly these names with these stamps */
+    bool load( const std::string& indexFile, const std::vector< std::string >& vNames, const std::vector< unsigned long long >& vStamps );
+
+    bool contains( const std::string& name ) const
+    {
+        return m_entries.count( name ) > 0;
+    }
+    const Region& get( const std::string& name ) const;
+    int getNumPages() const
+    {
+        return ( int )m_pages.size();
+    }
+    const Surface& getPage( const int idx ) const
+    {
+        return m_pages[ idx ];
+    }
+    size_t getMemoryUsage() const;                  /* pixel bytes of all pages */
+private:
+    struct Entry
+    {
+        Region region;
+        int page = 0;
+        unsigned long long stamp = 0;
+    };
+    struct Pending
+    {
+        std::string name;
+        Surface image;
+        unsigned long long stamp;
+    };
+    std::string pageFile( const std::string& indexFile, const int page ) const;
+
+    int m_pageSize;
+    std::vector< Surface > m_pages;                 /* not resized after build() / load(), the regions point into it */
+    std::unordered_map< std::string, Entry > m_entries;
+    std::vector< Pending > m_vPending;              /* added, not yet packed */
+};
@@ -0,0 +1,180 @@
+#include "SpriteCache.h"
+#include <assert.h>
+#include <algorithm>
+
+const RleSprite& SpriteCache::getRle( const SpriteAtlas::Region& s, const Color chroma, const int div, const int nCells )
+{
+    const Key key = makeKey( s, Effect::CHROMA, chroma.dword, 0, 0, div, nCells );
+    auto it = m_variants.find( key );
+    if( it != m_variants.end() )
+    {
+        return it->second;
+    }
+    if( div > 1 )
+    {
+        return m_variants.emplace( key, RleSprite( scaleDown( copyRegion( s ), chroma, div, nCells ), chroma ) ).first->second;
+    }
+    return m_variants.emplace( key, s.makeRle( chroma ) ).first->second;
+}
+
+const RleSprite& SpriteCache::getTeamColored( const SpriteAtlas::Region& s, const Color chroma, const Color chromaToSub, const Color team,
+                                              const int div, const int nCells )
+{
+    assert( team != chroma );   /* team colour would become transparent */
+
+    const Key key = makeKey( s, Effect::TEAM_COLOR, chroma.dword, chromaToSub.dword, team.dword, div, nCells );
+    auto it = m_variants.find( key );
+    if( it != m_variants.end() )
+    {
+        return it->second;
+    }
+
+    Surface variant = copyRegion( s );
+    for( int y = 0; y < variant.GetHeight(); ++y )
+    {
+        for( int x = 0; x < variant.GetWidth(); ++x )
+        {
+            if( variant.GetPixel( x, y ) == chromaToSub )
+            {
+                variant.PutPixel( x, y, team );
+            }
+        }
+    }
+    if( div > 1 )
+    {
+        variant = scaleDown( variant, chroma, div, nCells );
+    }
+    return m_variants.emplace( key, RleSprite( variant, chroma ) ).first->second;
+}
+
+const IndexedSprite& SpriteCache::getIndexed( const SpriteAtlas::Region& s, const Color chroma, const Color keyColor )
+{
+    const Key key = makeKey( s, Effect::INDEXED, chroma.dword, keyColor.dword, 0 );
+    auto it = m_indexed.find( key );
+    if( it != m_indexed.end() )
+    {
+        return it->second;
+    }
+    return m_indexed.emplace( key, s.makeIndexed( chroma, { keyColor } ) ).first->second;
+}
+
+const Surface& SpriteCache::getPremultiplied( const SpriteAtlas::Region& s, const Color chroma, const unsigned char alpha )
+{
+    const Key key = makeKey( s, Effect::PREMULTIPLIED, chroma.dword, alpha, 0 );
+    auto it = m_premultiplied.find( key );
+    if( it != m_premultiplied.end() )
+    {
+        return it->second;
+    }
+    return m_premultiplied.emplace( key, s.pPage->Premultiplied( s.rect, chroma, alpha ) ).first->second;
+}
+
+const Palette& SpriteCache::getTeamPalette( const IndexedSprite& s, const Color keyColor, const Color team )
+{
+    const auto key = std::make_tuple( s.GetId(), Effect::TEAM_COLOR, keyColor.dword, team.dword );
+    auto it = m_palettes.find( key );
+    if( it != m_palettes.end() )
+    {
+        return it->second;
+    }
+    return m_palettes.emplace( key, s.GetPalette().Substituted( keyColor, team ) ).first->second;
+}
+
+const Palette& SpriteCache::getSubstitutedPalette( const IndexedSprite& s, const Color sub )
+{
+    const auto key = std::make_tuple( s.GetId(), Effect::SUBSTITUTION, sub.dword, 0u );
+    auto it = m_palettes.find( key );
+    if( it != m_palettes.end() )
+    {
+        return it->second;
+    }
+    return m_palettes.emplace( key, s.GetPalette().Filled( sub ) ).first->second;
+}
+
+size_t SpriteCache::getMemoryUsage() const
+{
+    size_t bytes = m_palettes.size() * sizeof( Palette );
+    for( const auto& v : m_variants )
+    {
+        bytes += v.second.GetMemoryUsage();
+    }
+    for( const auto& v : m_indexed )
+    {
+        bytes += v.second.GetMemoryUsage();
+    }
+    for( const auto& v : m_premultiplied )
+    {
+        bytes += v.second.GetWidth() * v.second.GetHeight() * sizeof( Color );
+    }
+    return bytes;
+}
+
+const GunSprites& SpriteCache::getGun( const float gunLength, const Color team, const int div )
+{
+    const auto key = std::make_tuple( gunLength, team.dword, div );
+    auto it = m_guns.find( key );
+    if( it != m_guns.end() )
+    {
+        return it->second;
+    }
+    return m_guns.emplace( std::piecewise_construct, std::forward_as_tuple( key ), std::forward_as_tuple( gunLength, team, div ) ).first->second;
+}
+
+Surface SpriteCache::copyRegion( const SpriteAtlas::Region& s )
+{
+    Surface copy( s.getWidth(), s.getHeight() );
+    for( int y = 0; y < copy.GetHeight(); ++y )
+    {
+        const Color* pSrc = s.pPage->GetRow( s.rect.top + y ) + s.rect.left;
+        for( int x = 0; x < copy.GetWidth(); ++x )
+        {
+            copy.PutPixel( x, y, pSrc[ x ] );
+        }
+    }
+    return copy;
+}
+
+Surface SpriteCache::scaleDown( const Surface& s, const Color chroma, const int div, const int nCells )
+{
+    const int cellWidth = s.GetWidth() / nCells;
+    const int scaledCellWidth = std::max( cellWidth / div, 1 );
+    Surface scaled( nCells * scaledCellWidth, std::max( s.GetHeight() / div, 1 ) );
+    for( int y = 0; y < scaled.GetHeight(); ++y )
+    {
+        const int yEnd = std::min( ( y + 1 ) * div, s.GetHeight() );
+        for( int x = 0; x < scaled.GetWidth(); ++x )
+        {
+            const int xBegin = x / scaledCellWidth * cellWidth + x % scaledCellWidth * div;
+            const int xEnd = std::min( xBegin + div, ( x / scaledCellWidth + 1 ) * cellWidth );
+            int nOpaque = 0;
+            int nPixels = 0;
+            unsigned int r = 0, g = 0, b = 0;
+            for( int sy = y * div; sy < yEnd; ++sy )
+            {
+                const Color* pSrc = s.GetRow( sy );
+                for( int sx = xBegin; sx < xEnd; ++sx )
+                {
+                    nPixels++;
+                    if( pSrc[ sx ] != chroma )
+                    {
+                        nOpaque++;
+                        r += pSrc[ sx ].GetR();
+                        g += pSrc[ sx ].GetG();
+                        b += pSrc[ sx ].GetB();
+                    }
+                }
+            }
+            Color c = chroma;
+            if( nOpaque > 0 && 2 * nOpaque >= nPixels )
+            {
+                c = Color( ( unsigned char )( r / nOpaque ), ( unsigned char )( g / nOpaque ), ( unsigned char )( b / nOpaque ) );
+                if( c == chroma )
+                {
+                    c = Color( c.GetR(), c.GetG(), c.GetB() ^ 1u );     /* the average must not become transparent */
+                }
+            }
+            scaled.PutPixel( x, y, c );
+        }
+    }
+    return scaled;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <map>
+#include <tuple>
+#include "Surface.h"
+#include "SpriteAtlas.h"
+#include "GunSprites.h"
+#include "RleSprite.h"
+#include "Colors.h"
+
+/* pre-baked colour variants of sprites. Every variant is created once (first request) and stored run-length
+   encoded, so drawing it only copies the opaque spans. Palette indexed sprites share one set of indices for all of
+   their colour variants, only the palettes are baked. Returned references stay valid until clear(), the source
+   surfaces must not be modified or destroyed while the cache is in use (they are part of the key). A plain Surface
+   converts to a region covering all of it.
+   div > 1 gives a variant scaled down by div for the zoom levels (box filter, a pixel stays opaque if at least half of
+   its box is). Sprite sheets pass their number of cells per row (nCells), every cell is scaled on its own so the cells
+   keep equal integer widths */
+class SpriteCache
+{
+public:
+    /* unchanged colours (SpriteEffect::Chroma) */
+    const RleSprite& getRle( const SpriteAtlas::Region& s, const Color chroma, const int div = 1, const int nCells = 1 );
+    /* chromaToSub replaced by team (SpriteEffect::TeamColor) */
+    const RleSprite& getTeamColored( const SpriteAtlas::Region& s, const Color chroma, const Color chromaToSub, const Color team,
+                                     const int div = 1, const int nCells = 1 );
+    /* palette indexed, keyColor keeps an exact palette entry (pass chroma if there is none) */
+    const IndexedSprite& getIndexed( const SpriteAtlas::Region& s, const Color chroma, const Color keyColor );
+    /* palette swaps of an indexed sprite: keyColor replaced by team (SpriteEffect::TeamColor), every colour replaced
+       by sub (SpriteEffect::Substitution) */
+    const Palette& getTeamPalette( const IndexedSprite& s, const Color keyColor, const Color team );
+    const Palette& getSubstitutedPalette( const IndexedSprite& s, const Color sub );
+    /* copy with premultiplied alpha (Surface::Premultiplied()), drawn with SpriteEffect::AlphaBlend */
+    const Surface& getPremultiplied( const SpriteAtlas::Region& s, const Color chroma, const unsigned char alpha = 255 );
+    /* tank gun rotations in team colour, gunLength in pixels (full size), div: see GunSprites */
+    const GunSprites& getGun( const float gunLength, const Color team, const int div = 1 );
+
+    void clear()
+    {
+        m_variants.clear();
+        m_indexed.clear();
+        m_palettes.clear();
+        m_premultiplied.clear();
+        m_guns.clear();
+    }
+    int getNumVariants() const
+    {
+        return ( int )( m_variants.size() + m_palettes.size() );
+    }
+    size_t getMemoryUsage() const;      /* bytes of all baked sprites and palettes */
+private:
+    enum class Effect
+    {
+        CHROMA = 0,
+        TEAM_COLOR,
+        SUBSTITUTION,
+        INDEXED,
+        PREMULTIPLIED
+    };
+    /* surface, position in it, effect, colour parameters, scale (div, nCells) */
+    typedef std::tuple< const Surface*, int, int, Effect, unsigned int, unsigned int, unsigned int, int, int > Key;
+    static Key makeKey( const SpriteAtlas::Region& s, Effect effect, unsigned int c0, unsigned int c1, unsigned int c2, int div = 1, int nCells = 1 )
+    {
+        return Key( s.pPage, s.rect.left, s.rect.top, effect, c0, c1, c2, div, nCells );
+    }
+    static Surface copyRegion( const SpriteAtlas::Region& s );
+    static Surface scaleDown( const Surface& s, const Color chroma, const int div, const int nCells );
+
+    std::map< Key, RleSprite > m_variants;       /* map: references stay valid when new variants are added */
+    std::map< Key, IndexedSprite > m_indexed;
+    std::map< Key, Surface > m_premultiplied;
+    std::map< std::tuple< unsigned int, Effect, unsigned int, unsigned int >, Palette > m_palettes;    /* sprite id, effect, colours */
+    std::map< std::tuple< float, unsigned int, int >, GunSprites > m_guns;
+};
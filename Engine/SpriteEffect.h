@@ -2,7 +2,19 @@
 
 #include "Colors.h"
 #include "Graphics.h"
+#include <cstring>
+#include <algorithm>
 
+/* sse2 is always available on x64, on x86 only with /arch:SSE2 */
+#if defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ )
+#define SPRITE_EFFECT_SSE2 1
+#include <emmintrin.h>
+#else
+#define SPRITE_EFFECT_SSE2 0
+#endif
+
+/* every effect offers the per pixel operator() and DrawRow(), which processes a whole (already clipped) row.
+   DrawRow handles 4 pixels per step with sse2 and the remaining pixels with the scalar code */
 namespace SpriteEffect
 {
     class Chroma
@@ -20,6 +32,27 @@ namespace SpriteEffect
                 gfx.PutPixel( xDest, yDest, cSrc );
             }
         }
+        void DrawRow( const Color* pSrc, Color* pDst, int n ) const
+        {
+            int i = 0;
+#if SPRITE_EFFECT_SSE2
+            const __m128i key = _mm_set1_epi32( ( int )chroma.dword );
+            for( ; i + 4 <= n; i += 4 )
+            {
+                const __m128i src  = _mm_loadu_si128( ( const __m128i* )( pSrc + i ) );
+                const __m128i dst  = _mm_loadu_si128( ( const __m128i* )( pDst + i ) );
+                const __m128i mask = _mm_cmpeq_epi32( src, key );
+                _mm_storeu_si128( ( __m128i* )( pDst + i ), _mm_or_si128( _mm_and_si128( mask, dst ), _mm_andnot_si128( mask, src ) ) );
+            }
+#endif
+            for( ; i < n; ++i )
+            {
+                if( pSrc[ i ] != chroma )
+                {
+                    pDst[ i ] = pSrc[ i ];
+                }
+            }
+        }
     private:
         Color chroma;
     };
@@ -39,6 +72,28 @@ namespace SpriteEffect
                 gfx.PutPixel( xDest, yDest, sub );
             }
         }
+        void DrawRow( const Color* pSrc, Color* pDst, int n ) const
+        {
+            int i = 0;
+#if SPRITE_EFFECT_SSE2
+            const __m128i key   = _mm_set1_epi32( ( int )chroma.dword );
+            const __m128i color = _mm_set1_epi32( ( int )sub.dword );
+            for( ; i + 4 <= n; i += 4 )
+            {
+                const __m128i src  = _mm_loadu_si128( ( const __m128i* )( pSrc + i ) );
+                const __m128i dst  = _mm_loadu_si128( ( const __m128i* )( pDst + i ) );
+                const __m128i mask = _mm_cmpeq_epi32( src, key );
+                _mm_storeu_si128( ( __m128i* )( pDst + i ), _mm_or_si128( _mm_and_si128( mask, dst ), _mm_andnot_si128( mask, color ) ) );
+            }
+#endif
+            for( ; i < n; ++i )
+            {
+                if( pSrc[ i ] != chroma )
+                {
+                    pDst[ i ] = sub;
+                }
+            }
+        }
     private:
         Color chroma = Colors::Magenta;
         Color sub;
@@ -50,6 +105,10 @@ namespace SpriteEffect
         {
             gfx.PutPixel( xDest, yDest, cSrc );
         }
+        void DrawRow( const Color* pSrc, Color* pDst, int n ) const
+        {
+            memcpy( pDst, pSrc, n * sizeof( Color ) );
+        }
     };
     class Ghost
     {
@@ -65,17 +124,138 @@ namespace SpriteEffect
             {
                 const Color dest = gfx.GetPixel( xDest, yDest );
                 const Color blend ={
-                    unsigned char( ( src.GetR() + dest.GetR() ) / 2 ),
-                    unsigned char( ( src.GetG() + dest.GetG() ) / 2 ),
-                    unsigned char( ( src.GetB() + dest.GetB() ) / 2 )
+                    ( unsigned char )( ( src.GetR() + dest.GetR() ) / 2 ),
+                    ( unsigned char )( ( src.GetG() + dest.GetG() ) / 2 ),
+                    ( unsigned char )( ( src.GetB() + dest.GetB() ) / 2 )
                 };
                 gfx.PutPixel( xDest, yDest, blend );
             }
         }
+        void DrawRow( const Color* pSrc, Color* pDst, int n ) const
+        {
+            /* (a + b) / 2 per channel without overflow: (a & b) + ((a ^ b) >> 1), the mask drops the bit shifted in
+               from the neighbouring channel. the x channel is dropped, as in operator() */
+            int i = 0;
+#if SPRITE_EFFECT_SSE2
+            const __m128i key     = _mm_set1_epi32( ( int )chroma.dword );
+            const __m128i lowBits = _mm_set1_epi32( 0x007f7f7f );
+            const __m128i rgb     = _mm_set1_epi32( 0x00ffffff );
+            for( ; i + 4 <= n; i += 4 )
+            {
+                const __m128i src   = _mm_loadu_si128( ( const __m128i* )( pSrc + i ) );
+                const __m128i dst   = _mm_loadu_si128( ( const __m128i* )( pDst + i ) );
+                const __m128i mask  = _mm_cmpeq_epi32( src, key );
+                const __m128i half  = _mm_and_si128( _mm_srli_epi32( _mm_xor_si128( src, dst ), 1 ), lowBits );
+                const __m128i blend = _mm_and_si128( _mm_add_epi32( _mm_and_si128( src, dst ), half ), rgb );
+                _mm_storeu_si128( ( __m128i* )( pDst + i ), _mm_or_si128( _mm_and_si128( mask, dst ), _mm_andnot_si128( mask, blend ) ) );
+            }
+#endif
+            for( ; i < n; ++i )
+            {
+                if( pSrc[ i ] != chroma )
+                {
+                    const unsigned int a = pSrc[ i ].dword;
+                    const unsigned int b = pDst[ i ].dword;
+                    pDst[ i ] = ( ( a & b ) + ( ( ( a ^ b ) >> 1 ) & 0x007f7f7f ) ) & 0x00ffffff;
+                }
+            }
+        }
     private:
         Color chroma;
     };
 
+    /* premultiplied alpha (Surface::HasAlpha()) drawn over the frame: dst = src + dst * ( 255 - alpha ) / 255, everything
+       scaled by opacity first. Steps of fully opaque pixels are copied and fully transparent ones skipped, only the
+       rest is blended (16 bit per channel, / 255 rounded exactly) */
+    class AlphaBlend
+    {
+    public:
+        AlphaBlend( unsigned char opacity = 255 )
+            :
+            opacity( opacity )
+        {
+        }
+        void operator()( Color src, int xDest, int yDest, Graphics& gfx ) const
+        {
+            if( src.dword != 0 )
+            {
+                gfx.PutPixel( xDest, yDest, Blend( src.dword, gfx.GetPixel( xDest, yDest ).dword ) );
+            }
+        }
+        void DrawRow( const Color* pSrc, Color* pDst, int n ) const
+        {
+            int i = 0;
+#if SPRITE_EFFECT_SSE2
+            {
+                const __m128i zero    = _mm_setzero_si128();
+                const __m128i rgb     = _mm_set1_epi32( 0x00ffffff );
+                const __m128i opaque  = _mm_set1_epi32( ( int )0xff000000 );
+                const __m128i c255    = _mm_set1_epi16( 255 );
+                const __m128i c128    = _mm_set1_epi16( 128 );
+                const __m128i scale   = _mm_set1_epi16( opacity );
+                const __m128i c257    = _mm_set1_epi16( 257 );
+                const auto div255 = [ & ]( const __m128i x )     /* ( t + ( t >> 8 ) ) >> 8 == ( t * 257 ) >> 16 */
+                {
+                    return _mm_mulhi_epu16( _mm_add_epi16( x, c128 ), c257 );
+                };
+                const auto blend = [ & ]( __m128i s, const __m128i d )
+                {
+                    if( opacity != 255 )
+                    {
+                        s = div255( _mm_mullo_epi16( s, scale ) );
+                    }
+                    const __m128i a = _mm_shufflehi_epi16( _mm_shufflelo_epi16( s, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 3, 3, 3, 3 ) );
+                    return _mm_add_epi16( s, div255( _mm_mullo_epi16( d, _mm_sub_epi16( c255, a ) ) ) );
+                };
+                for( ; i + 4 <= n; i += 4 )
+                {
+                    const __m128i src = _mm_loadu_si128( ( const __m128i* )( pSrc + i ) );
+                    if( _mm_movemask_epi8( _mm_cmpeq_epi32( src, zero ) ) == 0xffff )
+                    {
+                        continue;
+                    }
+                    if( opacity == 255 && _mm_movemask_epi8( _mm_cmpeq_epi32( _mm_and_si128( src, opaque ), opaque ) ) == 0xffff )
+                    {
+                        _mm_storeu_si128( ( __m128i* )( pDst + i ), _mm_and_si128( src, rgb ) );
+                        continue;
+                    }
+                    const __m128i dst = _mm_loadu_si128( ( const __m128i* )( pDst + i ) );
+                    const __m128i lo  = blend( _mm_unpacklo_epi8( src, zero ), _mm_unpacklo_epi8( dst, zero ) );
+                    const __m128i hi  = blend( _mm_unpackhi_epi8( src, zero ), _mm_unpackhi_epi8( dst, zero ) );
+                    _mm_storeu_si128( ( __m128i* )( pDst + i ), _mm_and_si128( _mm_packus_epi16( lo, hi ), rgb ) );
+                }
+            }
+#endif
+            for( ; i < n; ++i )
+            {
+                if( pSrc[ i ].dword != 0 )
+                {
+                    pDst[ i ] = Blend( pSrc[ i ].dword, pDst[ i ].dword );
+                }
+            }
+        }
+    private:
+        static unsigned int Div255( unsigned int x )
+        {
+            x += 128;
+            return ( x + ( x >> 8 ) ) >> 8;
+        }
+        unsigned int Blend( unsigned int src, unsigned int dst ) const
+        {
+            unsigned int result = 0;
+            const unsigned int a = Div255( ( src >> 24 ) * opacity );
+            for( int shift = 0; shift < 24; shift += 8 )
+            {
+                const unsigned int s = Div255( ( ( src >> shift ) & 0xff ) * opacity );
+                const unsigned int d = ( dst >> shift ) & 0xff;
+                result |= std::min( s + Div255( d * ( 255 - a ) ), 255u ) << shift;
+            }
+            return result;
+        }
+    private:
+        unsigned int opacity;
+    };
+
     class TeamColor
     {
     public:
@@ -100,6 +280,32 @@ namespace SpriteEffect
                 }
             }
         }
+        void DrawRow( const Color* pSrc, Color* pDst, int n ) const
+        {
+            int i = 0;
+#if SPRITE_EFFECT_SSE2
+            const __m128i key    = _mm_set1_epi32( ( int )chroma.dword );
+            const __m128i subKey = _mm_set1_epi32( ( int )chromaToSub.dword );
+            const __m128i color  = _mm_set1_epi32( ( int )sub.dword );
+            for( ; i + 4 <= n; i += 4 )
+            {
+                const __m128i src     = _mm_loadu_si128( ( const __m128i* )( pSrc + i ) );
+                const __m128i dst     = _mm_loadu_si128( ( const __m128i* )( pDst + i ) );
+                const __m128i mask    = _mm_cmpeq_epi32( src, key );
+                const __m128i subMask = _mm_cmpeq_epi32( src, subKey );
+                const __m128i value   = _mm_or_si128( _mm_and_si128( subMask, color ), _mm_andnot_si128( subMask, src ) );
+                _mm_storeu_si128( ( __m128i* )( pDst + i ), _mm_or_si128( _mm_and_si128( mask, dst ), _mm_andnot_si128( mask, value ) ) );
+            }
+#endif
+            for( ; i < n; ++i )
+            {
+                const Color c = pSrc[ i ];
+                if( c != chroma )
+                {
+                    pDst[ i ] = ( c == chromaToSub ) ? sub : c;
+                }
+            }
+        }
     private:
         Color chroma = Colors::Magenta;
         Color chromaToSub;
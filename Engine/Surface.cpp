@@ -1,65 +1,184 @@
 #include "Surface.h"
-#include "ChiliWin.h"
 #include <cassert>
+#include <cstdint>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ )
+#define SURFACE_SSE2 1
+#include <emmintrin.h>
+#else
+#define SURFACE_SSE2 0
+#endif
+
+namespace
+{
+	// bmp headers as stored in the file (same layout as BITMAPFILEHEADER/BITMAPINFOHEADER,
+	// declared here so the loader does not depend on windows.h)
+#pragma pack( push,2 )
+	struct BmpFileHeader
+	{
+		uint16_t bfType;
+		uint32_t bfSize;
+		uint16_t bfReserved1;
+		uint16_t bfReserved2;
+		uint32_t bfOffBits;
+	};
+#pragma pack( pop )
+	struct BmpInfoHeader
+	{
+		uint32_t biSize;
+		int32_t  biWidth;
+		int32_t  biHeight;
+		uint16_t biPlanes;
+		uint16_t biBitCount;
+		uint32_t biCompression;
+		uint32_t biSizeImage;
+		int32_t  biXPelsPerMeter;
+		int32_t  biYPelsPerMeter;
+		uint32_t biClrUsed;
+		uint32_t biClrImportant;
+	};
+	static_assert( sizeof( BmpFileHeader ) == 14 && sizeof( BmpInfoHeader ) == 40,"bmp header layout" );
+	constexpr uint32_t bmpUncompressed = 0u;	// BI_RGB
+	constexpr uint32_t bmpBitFields = 3u;		// BI_BITFIELDS
+
+	// BGRX -> Color: the byte order already matches, only the X byte is cleared
+	void ConvertRow32( const unsigned char* pSrc,Color* pDst,int n )
+	{
+		int x = 0;
+#if SURFACE_SSE2
+		const __m128i rgbMask = _mm_set1_epi32( 0x00FFFFFF );
+		for( ; x + 4 <= n; x += 4 )
+		{
+			const __m128i px = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + x * 4) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + x),_mm_and_si128( px,rgbMask ) );
+		}
+#endif
+		for( ; x < n; x++ )
+		{
+			pDst[x] = Color( pSrc[x * 4 + 2],pSrc[x * 4 + 1],pSrc[x * 4] );
+		}
+	}
+
+	// BGRA -> premultiplied Color, the alpha byte is kept in x
+	inline unsigned char MulDiv255( unsigned int c,unsigned int a )
+	{
+		const unsigned int x = c * a + 128u;
+		return (unsigned char)((x + (x >> 8u)) >> 8u);
+	}
+	void ConvertRow32Premultiplied( const unsigned char* pSrc,Color* pDst,int n )
+	{
+		for( int x = 0; x < n; x++ )
+		{
+			const unsigned int a = pSrc[x * 4 + 3];
+			pDst[x] = Color( (unsigned char)a,MulDiv255( pSrc[x * 4 + 2],a ),MulDiv255( pSrc[x * 4 + 1],a ),MulDiv255( pSrc[x * 4],a ) );
+		}
+	}
+
+	// BGR -> Color: 4 pixels (12 bytes) per step, pixel i of the step is moved from byte 3i to byte 4i.
+	// The 16 byte load reads 4 bytes ahead, pEnd keeps it inside of the file data
+	void ConvertRow24( const unsigned char* pSrc,const unsigned char* pEnd,Color* pDst,int n )
+	{
+		int x = 0;
+#if SURFACE_SSE2
+		const __m128i mask0 = _mm_setr_epi32( 0x00FFFFFF,0,0,0 );
+		const __m128i mask1 = _mm_setr_epi32( 0,0x00FFFFFF,0,0 );
+		const __m128i mask2 = _mm_setr_epi32( 0,0,0x00FFFFFF,0 );
+		const __m128i mask3 = _mm_setr_epi32( 0,0,0,0x00FFFFFF );
+		for( ; x + 4 <= n && pSrc + x * 3 + 16 <= pEnd; x += 4 )
+		{
+			const __m128i px = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pSrc + x * 3) );
+			const __m128i result = _mm_or_si128(
+				_mm_or_si128( _mm_and_si128( px,mask0 ),_mm_and_si128( _mm_slli_si128( px,1 ),mask1 ) ),
+				_mm_or_si128( _mm_and_si128( _mm_slli_si128( px,2 ),mask2 ),_mm_and_si128( _mm_slli_si128( px,3 ),mask3 ) ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>(pDst + x),result );
+		}
+#endif
+		for( ; x < n; x++ )
+		{
+			pDst[x] = Color( pSrc[x * 3 + 2],pSrc[x * 3 + 1],pSrc[x * 3] );
+		}
+	}
+}
 
 Surface::Surface( const std::string& filename )
 {
-	std::ifstream file( filename,std::ios::binary );
+	// the whole file is read at once, rows are converted straight from that buffer
+	std::ifstream file( filename,std::ios::binary | std::ios::ate );
 	assert( file );
+	const size_t fileSize = size_t( file.tellg() );
+	std::vector<unsigned char> data( fileSize );
+	file.seekg( 0 );
+	file.read( reinterpret_cast<char*>(data.data()),fileSize );
+	assert( file );
+	assert( fileSize >= sizeof( BmpFileHeader ) + sizeof( BmpInfoHeader ) );
 
-	BITMAPFILEHEADER bmFileHeader;
-	file.read( reinterpret_cast<char*>(&bmFileHeader),sizeof( bmFileHeader ) );
+	BmpFileHeader bmFileHeader;
+	memcpy( &bmFileHeader,data.data(),sizeof( bmFileHeader ) );
 
-	BITMAPINFOHEADER bmInfoHeader;
-	file.read( reinterpret_cast<char*>(&bmInfoHeader),sizeof( bmInfoHeader ) );
+	BmpInfoHeader bmInfoHeader;
+	memcpy( &bmInfoHeader,data.data() + sizeof( bmFileHeader ),sizeof( bmInfoHeader ) );
 
 	assert( bmInfoHeader.biBitCount == 24 || bmInfoHeader.biBitCount == 32 );
-	assert( bmInfoHeader.biCompression == BI_RGB );
-
 	const bool is32b = bmInfoHeader.biBitCount == 32;
-
-	width = bmInfoHeader.biWidth;
-
-	// test for reverse row order and control
-	// y loop accordingly
-	int yStart;
-	int yEnd;
-	int dy;
-	if( bmInfoHeader.biHeight < 0 )
-	{
-		height = -bmInfoHeader.biHeight;
-		yStart = 0;
-		yEnd = height;
-		dy = 1;
-	}
-	else
+	// 32 bit files with alpha are usually written with bit fields, only the plain BGRA order is supported
+	assert( bmInfoHeader.biCompression == bmpUncompressed || (is32b && bmInfoHeader.biCompression == bmpBitFields) );
+	if( bmInfoHeader.biCompression == bmpBitFields )
 	{
-		height = bmInfoHeader.biHeight;
-		yStart = height - 1;
-		yEnd = -1;
-		dy = -1;
+		uint32_t masks[3];
+		assert( fileSize >= sizeof( BmpFileHeader ) + sizeof( BmpInfoHeader ) + sizeof( masks ) );
+		memcpy( masks,data.data() + sizeof( BmpFileHeader ) + sizeof( BmpInfoHeader ),sizeof( masks ) );
+		assert( masks[0] == 0x00FF0000u && masks[1] == 0x0000FF00u && masks[2] == 0x000000FFu );
 	}
 
+	width = bmInfoHeader.biWidth;
+	// negative height: rows are stored top-down, otherwise bottom-up
+	const bool topDown = bmInfoHeader.biHeight < 0;
+	height = topDown ? -bmInfoHeader.biHeight : bmInfoHeader.biHeight;
+
 	pPixels = new Color[width*height];
 
-	file.seekg( bmFileHeader.bfOffBits );
-	// padding is for the case of of 24 bit depth only
-	const int padding = (4 - (width * 3) % 4) % 4;
+	// rows are padded to 4 bytes (only matters for 24 bit depth)
+	const size_t pitch = (size_t( width ) * (is32b ? 4 : 3) + 3) & ~size_t( 3 );
+	assert( bmFileHeader.bfOffBits + pitch * (height - 1) + size_t( width ) * (is32b ? 4 : 3) <= fileSize );
+	const unsigned char* pEnd = data.data() + fileSize;
 
-	for( int y = yStart; y != yEnd; y += dy )
+	// most 32 bit files leave the 4th byte at zero or at 255 (opaque) everywhere, only a varying alpha channel is kept.
+	// The others load like 24 bit files with x = 0, so chroma keys still compare equal to whole dwords
+	if( is32b )
 	{
-		for( int x = 0; x < width; x++ )
+		bool anyVisible = false;
+		bool anyTranslucent = false;
+		for( int row = 0; row < height && !alpha; row++ )
 		{
-			PutPixel( x,y,Color( file.get(),file.get(),file.get() ) );
-			if( is32b )
+			const unsigned char* pSrc = data.data() + bmFileHeader.bfOffBits + pitch * row;
+			for( int x = 0; x < width; x++ )
 			{
-				file.seekg( 1,std::ios::cur );
+				anyVisible = anyVisible || pSrc[x * 4 + 3] != 0;
+				anyTranslucent = anyTranslucent || pSrc[x * 4 + 3] != 255;
 			}
+			alpha = anyVisible && anyTranslucent;
 		}
-		if( !is32b )
+	}
+
+	for( int row = 0; row < height; row++ )
+	{
+		const unsigned char* pSrc = data.data() + bmFileHeader.bfOffBits + pitch * row;
+		Color* pDst = &pPixels[(topDown ? row : height - 1 - row) * width];
+		if( alpha )
+		{
+			ConvertRow32Premultiplied( pSrc,pDst,width );
+		}
+		else if( is32b )
+		{
+			ConvertRow32( pSrc,pDst,width );
+		}
+		else
 		{
-			file.seekg( padding,std::ios::cur );
+			ConvertRow24( pSrc,pEnd,pDst,width );
 		}
 	}
 }
@@ -76,6 +195,7 @@ Surface::Surface( const Surface& rhs )
 	:
 	Surface( rhs.width,rhs.height )
 {
+	alpha = rhs.alpha;
 	const int nPixels = width * height;
 	for( int i = 0; i < nPixels; i++ )
 	{
@@ -83,6 +203,18 @@ Surface::Surface( const Surface& rhs )
 	}
 }
 
+Surface::Surface( Surface&& donor ) noexcept
+	:
+	pPixels( donor.pPixels ),
+	width( donor.width ),
+	height( donor.height ),
+	alpha( donor.alpha )
+{
+	donor.pPixels = nullptr;
+	donor.width = 0;
+	donor.height = 0;
+}
+
 Surface::~Surface()
 {
 	delete [] pPixels;
@@ -93,6 +225,7 @@ Surface& Surface::operator=( const Surface& rhs )
 {
 	width = rhs.width;
 	height = rhs.height;
+	alpha = rhs.alpha;
 
 	delete [] pPixels;
 	pPixels = new Color[width*height];
@@ -105,6 +238,22 @@ Surface& Surface::operator=( const Surface& rhs )
 	return *this;
 }
 
+Surface& Surface::operator=( Surface&& donor ) noexcept
+{
+	if( this != &donor )
+	{
+		delete [] pPixels;
+		pPixels = donor.pPixels;
+		width = donor.width;
+		height = donor.height;
+		alpha = donor.alpha;
+		donor.pPixels = nullptr;
+		donor.width = 0;
+		donor.height = 0;
+	}
+	return *this;
+}
+
 void Surface::PutPixel( int x,int y,Color c )
 {
 	assert( x >= 0 );
@@ -114,6 +263,22 @@ void Surface::PutPixel( int x,int y,Color c )
 	pPixels[y * width + x] = c;
 }
 
+void Surface::Fill( const RectI& rect,Color c )
+{
+	const int left = std::max( rect.left,0 );
+	const int right = std::min( rect.right,width );
+	const int top = std::max( rect.top,0 );
+	const int bottom = std::min( rect.bottom,height );
+	if( left >= right )
+	{
+		return;
+	}
+	for( int y = top; y < bottom; y++ )
+	{
+		std::fill( pPixels + y * width + left,pPixels + y * width + right,c );
+	}
+}
+
 Color Surface::GetPixel( int x,int y ) const
 {
 	assert( x >= 0 );
@@ -123,6 +288,13 @@ Color Surface::GetPixel( int x,int y ) const
 	return pPixels[y * width + x];
 }
 
+const Color* Surface::GetRow( int y ) const
+{
+	assert( y >= 0 );
+	assert( y < height );
+	return &pPixels[y * width];
+}
+
 int Surface::GetWidth() const
 {
 	return width;
@@ -137,3 +309,27 @@ RectI Surface::GetRect() const
 {
 	return{ 0,width,0,height };
 }
+
+bool Surface::HasAlpha() const
+{
+	return alpha;
+}
+
+Surface Surface::Premultiplied( const RectI& srcRect,Color chroma,unsigned char a ) const
+{
+	assert( !alpha );
+	assert( srcRect.IsContainedBy( GetRect() ) );
+	Surface s( srcRect.GetWidth(),srcRect.GetHeight() );
+	s.alpha = true;
+	for( int y = 0; y < s.height; y++ )
+	{
+		const Color* pSrc = GetRow( srcRect.top + y ) + srcRect.left;
+		Color* pDst = &s.pPixels[y * s.width];
+		for( int x = 0; x < s.width; x++ )
+		{
+			const Color c = pSrc[x];
+			pDst[x] = c == chroma ? Color( 0u ) : Color( a,MulDiv255( c.GetR(),a ),MulDiv255( c.GetG(),a ),MulDiv255( c.GetB(),a ) );
+		}
+	}
+	return s;
+}
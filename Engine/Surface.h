@@ -10,15 +10,25 @@ public:
 	Surface( const std::string& filename );
 	Surface( int width,int height );
 	Surface( const Surface& );
+	Surface( Surface&& donor ) noexcept;	// takes over the pixels, donor is left empty
 	~Surface();
 	Surface& operator=( const Surface& );
+	Surface& operator=( Surface&& donor ) noexcept;
 	void PutPixel( int x,int y,Color c );
+	void Fill( const RectI& rect,Color c );	/* clipped to the surface */
 	Color GetPixel( int x,int y ) const;
+	const Color* GetRow( int y ) const;
 	int GetWidth() const;
 	int GetHeight() const;
 	RectI GetRect() const;
+	// premultiplied alpha in the x byte: 32 bit bmps with an alpha channel and Premultiplied() copies.
+	// All other surfaces keep x = 0, chroma keys compare whole dwords
+	bool HasAlpha() const;
+	// copy of srcRect with premultiplied alpha, chroma pixels become fully transparent, all others get alpha
+	Surface Premultiplied( const RectI& srcRect,Color chroma,unsigned char alpha = 255 ) const;
 private:
 	Color* pPixels = nullptr;
 	int width;
 	int height;
+	bool alpha = false;
 };
\ No newline at end of file
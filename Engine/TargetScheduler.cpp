@@ -0,0 +1,106 @@
+#include "TargetScheduler.h"
+#include "Unit.h"
+
+TargetScheduler::TargetScheduler( UnitActivity& activity, const UnitGrid& grid, const VisibilityGrid& visibility, const float scanInterval, const int maxScansPerFrame )
+    :
+    m_activity( activity ),
+    m_grid( grid ),
+    m_visibility( visibility )
+{
+    setScanInterval( scanInterval );
+    setMaxScansPerFrame( maxScansPerFrame );
+}
+
+void TargetScheduler::update( const float dt )
+{
+    m_nScansLastFrame = 0;
+
+    /* an enemy entered a new cell -> wake all idle units around it */
+    for( const auto moved : m_grid.getMovedUnits() )
+    {
+        m_grid.forEachInNeighbourhood( moved->getGridCellIdx(), [ this, moved ]( Unit* u )
+        {
+            if( u->getTeam() != moved->getTeam() && Unit::State::STANDING == u->getState() )
+            {
+                m_activity.wake( u );
+                wake( u );
+            }
+        } );
+    }
+    for( const auto u : m_vpWokenUnits )
+    {
+        scan( u );
+    }
+    m_vpWokenUnits.clear();
+
+    const std::vector< Unit* >& vpUnits = m_activity.getActiveUnits();
+    if( vpUnits.empty() )
+    {
+        return;
+    }
+
+    /* round-robin batch, sized so that every unit is visited once per scan interval */
+    m_visitCredit += vpUnits.size() * dt / m_scanInterval;
+    const int nVisits = std::min( ( int )m_visitCredit, std::min( m_maxScansPerFrame, ( int )vpUnits.size() ) );
+    m_visitCredit = std::min( m_visitCredit - nVisits, ( float )m_maxScansPerFrame );
+
+    for( int i = 0; i < nVisits; ++i )
+    {
+        if( m_nextIdx >= vpUnits.size() )
+        {
+            m_nextIdx = 0;
+        }
+        Unit* const u = vpUnits[ m_nextIdx++ ];
+        if( Unit::State::STANDING == u->getState() )
+        {
+            scan( u );
+        }
+    }
+
+    /* not done inside the loop above, sleep() reorders the active units */
+    for( const auto u : m_vpSleepyUnits )
+    {
+        m_activity.sleep( u );
+    }
+    m_vpSleepyUnits.clear();
+}
+
+void TargetScheduler::wake( Unit* const pUnit )
+{
+    if( std::find( m_vpWokenUnits.begin(), m_vpWokenUnits.end(), pUnit ) == m_vpWokenUnits.end() )
+    {
+        m_vpWokenUnits.push_back( pUnit );
+    }
+}
+
+void TargetScheduler::remove( const Unit* const pUnit )
+{
+    auto it = std::find( m_vpWokenUnits.begin(), m_vpWokenUnits.end(), pUnit );
+    if( it != m_vpWokenUnits.end() )
+    {
+        m_vpWokenUnits.erase( it );
+    }
+    it = std::find( m_vpSleepyUnits.begin(), m_vpSleepyUnits.end(), pUnit );
+    if( it != m_vpSleepyUnits.end() )
+    {
+        m_vpSleepyUnits.erase( it );
+    }
+}
+
+void TargetScheduler::clear()
+{
+    m_vpWokenUnits.clear();
+    m_vpSleepyUnits.clear();
+    m_nextIdx       = 0;
+    m_visitCredit   = 0.0f;
+}
+
+void TargetScheduler::scan( Unit* const pUnit )
+{
+    bool enemyInNeighbourhood = false;
+    if( !pUnit->checkForEnemiesInRadius( m_grid, m_visibility, enemyInNeighbourhood ) && !enemyInNeighbourhood && pUnit->isIdle() )
+    {
+        m_vpSleepyUnits.push_back( pUnit );
+    }
+    m_nScansLastFrame++;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include "UnitGrid.h"
+#include "UnitActivity.h"
+#include "VisibilityGrid.h"
+
+class Unit;
+
+/* schedules the enemy scans of idle (standing) units: every active unit is visited once per scan interval in round-robin
+   batches, units next to an enemy which just entered their cell neighbourhood are woken up and scanned immediately.
+   Idle units without any enemy in their cell neighbourhood are sent to the dormant set */
+class TargetScheduler
+{
+public:
+    TargetScheduler( UnitActivity& activity, const UnitGrid& grid, const VisibilityGrid& visibility, const float scanInterval = 0.2f, const int maxScansPerFrame = 64 );
+
+    void update( const float dt );      /* call after UnitGrid::update() and VisibilityGrid::update() */
+    void wake( Unit* const pUnit );     /* scan this unit during the next update */
+    void remove( const Unit* const pUnit );
+    void clear();
+
+    void setScanInterval( const float scanInterval )
+    {
+        assert( scanInterval > 0.0f );
+        m_scanInterval = scanInterval;
+    }
+    void setMaxScansPerFrame( const int maxScansPerFrame )
+    {
+        assert( maxScansPerFrame > 0 );
+        m_maxScansPerFrame = maxScansPerFrame;
+    }
+    int getScansLastFrame() const
+    {
+        return m_nScansLastFrame;
+    }
+private:
+    void scan( Unit* const pUnit );
+
+    UnitActivity& m_activity;
+    const UnitGrid& m_grid;
+    const VisibilityGrid& m_visibility;
+
+    float m_scanInterval;               /* in seconds, every unit is visited once during this time */
+    int m_maxScansPerFrame;             /* upper bound of round-robin visits per frame (keeps the frame cost flat) */
+
+    std::vector< Unit* > m_vpWokenUnits;
+    std::vector< Unit* > m_vpSleepyUnits;       /* sent to the dormant set after the round-robin batch */
+    size_t m_nextIdx = 0;               /* round-robin position in m_vpUnits */
+    float m_visitCredit = 0.0f;         /* fractional number of visits carried over to the next frame */
+    int m_nScansLastFrame = 0;
+};
@@ -1,5 +1,6 @@
 #include "Unit.h"
-#include "SpriteEffect.h"
+#include "UnitGrid.h"
+#include "VisibilityGrid.h"
 #include <assert.h>
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -11,13 +12,16 @@ Unit::Unit( const Vei2 pos_tile,
             const Level& level,
             PathFinder& pathFinder,
             std::vector< Unit* >& vpUnits,
+            CombatEventQueue& combatEvents,
             const UnitType type,
-            const std::vector< Surface >& vSprites,
+            const std::vector< SpriteAtlas::Region >& vSprites,
+            SpriteCache& spriteCache,
             std::vector< Sound >& vSoundEffects )
     :
     m_level( level ),
     m_pathFinder( pathFinder ),
     m_vpUnits( vpUnits ),
+    m_combatEvents( combatEvents ),
     m_vSprites( vSprites ),
     m_vSoundEffects( vSoundEffects )
 {
@@ -26,7 +30,7 @@ Unit::Unit( const Vei2 pos_tile,
             && pos_tile.y >= 0 && pos_tile.y < level.getHeightInTiles() );
 
     m_type      = type;
-    m_size      = m_vSprites[ ( int )SpriteOrder::UNIT ].GetHeight();
+    m_size      = m_vSprites[ ( int )SpriteOrder::UNIT ].getHeight();
 
     /* calculating rectangles for unit sprite steps (directions) */
     for( int i = 0; i < 8; ++i )
@@ -38,17 +42,26 @@ Unit::Unit( const Vei2 pos_tile,
     m_location.y    = pos_tile.y * m_level.getTileSize() + m_level.getTileSize() / 2.0f - 1;
     m_tileIdx       = m_level.getTileIdx( m_location );
     m_team          = team;
-    if( Team::_A == m_team )
-    {
-        m_color = Colors::Blue;
-    }
-    else if( Team::_B == m_team )
+    m_color         = getTeamColor( m_team );
+
+    /* colour variants are shared by all units with the same sprites and team */
+    const Color teamKey = { 255, 242, 0 };
+    mp_sprite       = &spriteCache.getIndexed( m_vSprites[ ( int )SpriteOrder::UNIT ], Colors::White, teamKey );
+    mp_teamPalette  = &spriteCache.getTeamPalette( *mp_sprite, teamKey, m_color );
+    mp_dmgPalette   = &spriteCache.getSubstitutedPalette( *mp_sprite, Colors::Red );
+    mp_shotSprite   = &spriteCache.getIndexed( m_vSprites[ ( int )SpriteOrder::SHOT ], Colors::White, Colors::White );
+    if( UnitType::TANK == type )
     {
-        m_color = Colors::Red;
+        mp_gunSprites = &spriteCache.getGun( getGunLength( m_size ), m_color );
     }
-    else
+    for( int zoom = 1; zoom < m_dotZoom; ++zoom )
     {
-        m_color = Colors::Yellow;
+        const int div = 1 << zoom;
+        m_zoomSprites[ zoom ] = &spriteCache.getTeamColored( m_vSprites[ ( int )SpriteOrder::UNIT ], Colors::White, teamKey, m_color, div, 8 );
+        if( UnitType::TANK == type )
+        {
+            m_zoomGuns[ zoom ] = &spriteCache.getGun( getGunLength( m_size ), m_color, div );
+        }
     }
 
     m_bIsGroundUnit = true;
@@ -58,6 +71,7 @@ Unit::Unit( const Vei2 pos_tile,
         m_maxForce              = 0.3f;
         m_life                  = 200;
         m_attackRadius          = 115;
+        m_visionRadius          = 200;
         m_attackDamage          = 20;
         m_timeBetweenAttacks    = 1000;
     }
@@ -68,6 +82,7 @@ Unit::Unit( const Vei2 pos_tile,
         m_bIsGroundUnit         = false;
         m_life                  = 100;
         m_attackRadius          = 150;
+        m_visionRadius          = 250;
         m_attackDamage          = 10;
         m_timeBetweenAttacks    = 300;
     }
@@ -77,6 +92,7 @@ Unit::Unit( const Vei2 pos_tile,
         m_maxForce              = 0.5f;
         m_life                  = 50;
         m_attackRadius          = 70;
+        m_visionRadius          = 150;
         m_attackDamage          = 5;
         m_timeBetweenAttacks    = 200;
     }
@@ -99,17 +115,14 @@ Unit::Unit( const Vei2 pos_tile,
     m_velocity.y        = 0;
 }
 
-void Unit::draw( Graphics& gfx, const Vei2& camPos, const bool drawExtraInfos ) const
+void Unit::draw( Graphics& gfx, const Vei2& offset, const bool drawExtraInfos ) const
 {
-    const Vei2 halfScreen( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
-    const Vei2 offset = camPos - halfScreen;
-
     /* drawing extra infos, like current path or attackRadius */
     if( drawExtraInfos )
     {
         if( State::MOVING == m_state )
         {
-            m_path.draw( gfx, camPos );
+            m_path.draw( gfx, offset + Vei2( Graphics::halfScreenWidth, Graphics::halfScreenHeight ) );
         }
                 
         if( m_state == State::ATTACKING )
@@ -132,16 +145,8 @@ void Unit::draw( Graphics& gfx, const Vei2& camPos, const bool drawExtraInfos )
         gfx.DrawRectCorners( bb, Colors::White );
     }
     
-    if( m_bDmgEffectActive )
-    {
-        gfx.DrawSprite( ( int )m_location.x - m_halfSize - offset.x, ( int )m_location.y - m_halfSize - offset.y, m_vSpriteRects[ ( int )m_spriteDirection ],
-                        m_vSprites[ ( int )SpriteOrder::UNIT ], SpriteEffect::Substitution( Colors::White, Colors::Red ) );
-    }
-    else
-    {
-        gfx.DrawSprite( ( int )m_location.x - m_halfSize - offset.x, ( int )m_location.y - m_halfSize - offset.y, m_vSpriteRects[ ( int )m_spriteDirection ],
-                        m_vSprites[ ( int )SpriteOrder::UNIT ], SpriteEffect::TeamColor( Colors::White, { 255, 242, 0 }, m_color ) );
-    }
+    gfx.DrawSprite( ( int )m_location.x - m_halfSize - offset.x, ( int )m_location.y - m_halfSize - offset.y, m_vSpriteRects[ ( int )m_spriteDirection ],
+                    *mp_sprite, m_bDmgEffectActive ? *mp_dmgPalette : *mp_teamPalette );
 
     if( UnitType::TANK == m_type )
     {
@@ -158,8 +163,42 @@ void Unit::draw( Graphics& gfx, const Vei2& camPos, const bool drawExtraInfos )
     gfx.DrawRectBorder( bb, 1, Colors::White );
 #endif
 }
-void Unit::update( const float dt )
+void Unit::drawZoomed( Graphics& gfx, const Vei2& offset, const int zoom ) const
+{
+    assert( zoom > 0 );
+    const int div = 1 << zoom;
+    const Vei2 pos = getLocationInt() / div - offset;
+    if( zoom >= m_dotZoom )
+    {
+        gfx.DrawRect( RectI( pos - Vei2( 1, 1 ), 3, 3 ), m_bSelected ? Colors::Green : m_color );
+        return;
+    }
+
+    const int size = m_size / div;
+    const int half = size / 2;
+    gfx.DrawSprite( pos.x - half, pos.y - half, RectI( ( int )m_spriteDirection * size, ( ( int )m_spriteDirection + 1 ) * size, 0, size ),
+                    *m_zoomSprites[ zoom ] );
+    if( UnitType::TANK == m_type )
+    {
+        m_zoomGuns[ zoom ]->draw( gfx, pos, GunSprites::angleIndex( m_cannonOrientation ) );
+    }
+    if( m_bSelected )
+    {
+        gfx.DrawRectCorners( RectF( Vec2( ( float )( pos.x - half ), ( float )( pos.y - half ) ), ( float )size, ( float )size ), Colors::Green );
+    }
+}
+
+void Unit::update( const float dt, const int nFrames )
 {
+    m_forceScale = ( float )nFrames;
+
+    // effects are not visible with reduced detail -> switch them off
+    if( !m_bFullDetail )
+    {
+        m_bDmgEffectActive  = false;
+        m_bShotEffectActive = false;
+    }
+
     // update damage effect time if active
     if( m_bDmgEffectActive )
     {
@@ -195,7 +234,7 @@ void Unit::update( const float dt )
             }
         }
 
-        if( UnitType::TANK == m_type )
+        if( UnitType::TANK == m_type && m_bFullDetail )
         {
             Vec2 dir = mp_currentEnemy->getLocation() - m_location;
             m_cannonOrientation = atan2( dir.y, dir.x );
@@ -240,7 +279,10 @@ void Unit::update( const float dt )
         }
 
         m_velocity += m_acceleration;
-        calcSpriteDirection();
+        if( m_bFullDetail )
+        {
+            calcSpriteDirection();
+        }
         if( m_velocity.GetLength() > m_maxSpeed * dt )
         {
             m_velocity.Normalize();
@@ -290,7 +332,10 @@ void Unit::update( const float dt )
             if( UnitType::JET == m_type )
             {
                 m_velocity = mp_currentEnemy->getLocation() - m_location;
-                calcSpriteDirection();
+                if( m_bFullDetail )
+                {
+                    calcSpriteDirection();
+                }
             }
 
             std::chrono::steady_clock::time_point currTime = std::chrono::steady_clock::now();
@@ -306,65 +351,68 @@ void Unit::update( const float dt )
             m_state = State::MOVING;
         }
     }
-    else if( State::STANDING == m_state )
-    {
-        checkForEnemiesInRadius();
-    }
 }
 void Unit::shoot()
 {
-#if !_DEBUG
-    m_vSoundEffects[ ( int )SoundOrder::ATTACK ].Play();
-#endif
-    mp_currentEnemy->takeDamage( m_attackDamage, m_type, this );
-
-    if( mp_currentEnemy->isDestroyed() )
-    {
-        mp_currentEnemy = nullptr;
-        m_state = State::STANDING;
-    }
+    /* damage, sound and death are applied in CombatEventQueue::resolve(), a destroyed enemy
+       is reported back via checkDestroyedEnemy() */
+    m_combatEvents.pushDamage( mp_currentEnemy, this, m_attackDamage, m_type );
 
     m_bShotEffectActive = true;
     m_shotEffectTime = 0.0f;
 }
-void Unit::checkForEnemiesInRadius()
+bool Unit::checkForEnemiesInRadius( const UnitGrid& grid, const VisibilityGrid& visibility, bool& enemyInNeighbourhood )
 {
+    enemyInNeighbourhood = false;
     if( m_state != State::STANDING )
     {
-        return;
+        return false;
     }
+    assert( m_gridCellIdx >= 0 );
+    assert( m_attackRadius <= grid.getCellSize() );     /* otherwise the cell neighbourhood does not cover the attack radius */
 
-    for( const auto u: m_vpUnits )
+    /* nearest enemy inside the attack radius (squared distances, no sqrt needed) */
+    Unit* pNearest = nullptr;
+    float nearestDistSq = m_attackRadius * m_attackRadius;
+    grid.forEachInNeighbourhood( m_gridCellIdx, [ this, &visibility, &pNearest, &nearestDistSq, &enemyInNeighbourhood ]( Unit* u )
     {
-        if( u->getTeam() == m_team )
+        if( u->getTeam() == m_team || u->isDestroyed() )
         {
-            continue;
+            return;
         }
-        const float d = ( u->getLocation() - m_location ).GetLength();
-
-        if( d <= m_attackRadius )
+        enemyInNeighbourhood = true;
+        if( !visibility.isVisible( m_team, u->getTileIdx() ) )
         {
-            mp_currentEnemy = u;
-            m_state = State::ATTACKING;
             return;
         }
+        const float dSq = ( u->getLocation() - m_location ).GetLengthSq();
+        if( dSq <= nearestDistSq )
+        {
+            pNearest        = u;
+            nearestDistSq   = dSq;
+        }
+    } );
+
+    if( pNearest )
+    {
+        mp_currentEnemy = pNearest;
+        m_state = State::ATTACKING;
+        return true;
     }
+    return false;
 }
-void Unit::handleMouse( const Mouse::Event::Type& type, const Vec2& mousePos, const Vei2& camPos, const bool shift_pressed )
+bool Unit::handleMouse( const Mouse::Event::Type& type, const Vec2& mousePos, const Vei2& camPos, const bool shift_pressed )
 {
-    const Vei2 halfScreen( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
-    const Vei2 offset = camPos - halfScreen;
-
 #if !_DEBUG  /* in debug mode we can select and give commands to enemies */
     if( Team::_A != m_team )
     {
-        return;
+        return false;
     }
 #endif
 
     if( type == Mouse::Event::Type::LPress )
     {
-        RectF bb( m_bb.left - offset.x, m_bb.right - offset.x, m_bb.top - offset.y, m_bb.bottom - offset.y );
+        RectF bb = m_level.worldToScreen( m_bb, camPos );
         if( !m_bSelected )
         {
             /* check if we click inside the bounding box */
@@ -385,13 +433,14 @@ void Unit::handleMouse( const Mouse::Event::Type& type, const Vec2& mousePos, co
     {
         if( m_bSelected )
         {
-            Tile targetTile     = m_level.getTileType( ( int )mousePos.x + offset.x, ( int )mousePos.y + offset.y );
+            const Vec2 target   = m_level.screenToWorld( mousePos, camPos );
+            Tile targetTile     = m_level.getTileType( ( int )target.x, ( int )target.y );
             const int startIdx  = m_level.getTileIdx( m_location );
-            m_targetIdx         = m_level.getTileIdx( ( int )mousePos.x + offset.x, ( int )mousePos.y + offset.y );
+            m_targetIdx         = m_level.getTileIdx( ( int )target.x, ( int )target.y );
 
             if( startIdx == m_targetIdx || ( Tile::OBSTACLE == m_level.getTileType( m_targetIdx ) && m_bIsGroundUnit ) )
             {
-                return;
+                return false;
             }
 
             /* check if target is an enemy */
@@ -414,7 +463,7 @@ void Unit::handleMouse( const Mouse::Event::Type& type, const Vec2& mousePos, co
                 if( distToEnemy <= m_attackRadius )
                 {
                     m_state = State::ATTACKING;
-                    return;
+                    return true;
                 }
             }
 
@@ -432,6 +481,7 @@ void Unit::handleMouse( const Mouse::Event::Type& type, const Vec2& mousePos, co
 #if !_DEBUG
                 m_vSoundEffects[ ( int )SoundOrder::COMMAND ].Play( 1, 0.5f );
 #endif
+                return true;
             }
             else
             {
@@ -444,34 +494,16 @@ void Unit::handleMouse( const Mouse::Event::Type& type, const Vec2& mousePos, co
 #if !_DEBUG
                     m_vSoundEffects[ ( int )SoundOrder::COMMAND ].Play( 1, 0.5f );
 #endif
+                    return true;
                 }
             }
         }
     }
+    return false;
 }
 void Unit::drawGun( Graphics& gfx, const Vei2& offset ) const
 {
-    const int x     = ( int )m_location.x - offset.x;
-    const int y     = ( int )m_location.y - offset.y;
-    const int newX  = x + ( int )( GUN_LENGTH * m_size * cos( m_cannonOrientation ) );
-    const int newY  = y + ( int )( GUN_LENGTH * m_size * sin( m_cannonOrientation ) );
-    
-    // draw team color
-    gfx.DrawCircle( Vei2( x, y ), 7, m_color );
-
-    Color colorGun = { 115, 115, 115 };
-    Color colorGun2 = { 75, 75, 75 };
-    gfx.DrawLine( x, y, newX, newY, colorGun );
-    gfx.DrawLine( x + 1, y, newX + 1, newY, colorGun );
-    gfx.DrawLine( x + 2, y, newX + 2, newY, colorGun );
-    gfx.DrawLine( x - 1, y, newX - 1, newY, colorGun );
-    gfx.DrawLine( x - 2, y, newX - 2, newY, colorGun );
-    gfx.DrawLine( x, y + 1, newX, newY + 1, colorGun );
-    gfx.DrawLine( x, y + 2, newX, newY + 2, colorGun );
-    gfx.DrawLine( x, y - 1, newX, newY - 1, colorGun );
-    gfx.DrawLine( x, y - 2, newX, newY - 2, colorGun );
-    gfx.DrawCircle( ( x + newX ) / 2, ( y + newY ) / 2, 4, m_color );
-    gfx.DrawCircle( newX, newY, 2, colorGun2 );
+    mp_gunSprites->draw( gfx, getLocationInt() - offset, GunSprites::angleIndex( m_cannonOrientation ) );
 }
 void Unit::drawShotEffect( Graphics& gfx, const Vei2& offset ) const
 {
@@ -481,11 +513,13 @@ void Unit::drawShotEffect( Graphics& gfx, const Vei2& offset ) const
 
     if( UnitType::TANK == m_type )
     {
-        const int hs = m_vSprites[ ( int )SpriteOrder::SHOT ].GetHeight() / 2;
-        const int x = ( int )m_location.x + ( int )( GUN_LENGTH * m_size * cos( m_cannonOrientation ) ) - offset.x;
-        const int y = ( int )m_location.y + ( int )( GUN_LENGTH * m_size * sin( m_cannonOrientation ) ) - offset.y;
+        const int hs = m_vSprites[ ( int )SpriteOrder::SHOT ].getHeight() / 2;
+        /* muzzle of the pre-rendered gun, same angle as drawn */
+        const Vei2 muzzle = getLocationInt() + mp_gunSprites->getMuzzleOffset( GunSprites::angleIndex( m_cannonOrientation ) ) - offset;
+        const int x = muzzle.x;
+        const int y = muzzle.y;
         
-        gfx.DrawSprite( x - hs, y - hs, m_vSprites[ ( int )SpriteOrder::SHOT ], SpriteEffect::Chroma( Colors::White ) );
+        gfx.DrawSprite( x - hs, y - hs, *mp_shotSprite );
 
         Vec2 shot = Vec2( ( float )x, ( float )y ) + ( ep - Vec2( ( float )x, ( float )y ) ) * ratio;
         gfx.DrawCircle( shot, 4, Colors::Gray );
@@ -577,10 +611,20 @@ void Unit::calcSpriteDirection()
         m_spriteDirection = Direction::DOWN;
     }
 }
-void Unit::drawLifeBar( Graphics& gfx, const Vei2& camPos ) const
+void Unit::updateCosmetics()
+{
+    if( m_velocity.GetLengthSq() > 0.0f )
+    {
+        calcSpriteDirection();
+    }
+    if( UnitType::TANK == m_type && mp_currentEnemy )
+    {
+        Vec2 dir = mp_currentEnemy->getLocation() - m_location;
+        m_cannonOrientation = atan2( dir.y, dir.x );
+    }
+}
+void Unit::drawLifeBar( Graphics& gfx, const Vei2& offset ) const
 {
-    const Vei2 halfScreen( Graphics::halfScreenWidth, Graphics::halfScreenHeight );
-    const Vei2 offset = camPos - halfScreen;
     Color lifebarColor;
     const int x = ( int )m_location.x - offset.x;
     const int y = ( int )m_location.y - offset.y;
@@ -604,13 +648,63 @@ void Unit::drawLifeBar( Graphics& gfx, const Vei2& camPos ) const
     }
 
     int barPosY = y - ( int )( 1.3f * m_halfSize );
-    gfx.DrawLine( x - m_halfSize + ( int )( ( 1 - lifeMaxLifeRatio ) * m_size ), barPosY + 1, x + m_halfSize, barPosY + 1, lifebarColor );
-    gfx.DrawLine( x - m_halfSize + ( int )( ( 1 - lifeMaxLifeRatio ) * m_size ), barPosY, x + m_halfSize, barPosY, lifebarColor );
-    gfx.DrawLine( x - m_halfSize + ( int )( ( 1 - lifeMaxLifeRatio ) * m_size ), barPosY - 1, x + m_halfSize, barPosY - 1, lifebarColor );
-    gfx.DrawLine( x - m_halfSize, barPosY - 2, x + m_halfSize, barPosY - 2, Colors::White );		// top border   -----
-    gfx.DrawLine( x - m_halfSize, barPosY - 2, x - m_halfSize, barPosY + 2, Colors::White );		// left border  |_____
-    gfx.DrawLine( x + m_halfSize, barPosY - 2, x + m_halfSize, barPosY + 2, Colors::White );		// right border _____|
-    gfx.DrawLine( x - m_halfSize, barPosY + 2, x + m_halfSize, barPosY + 2, Colors::White );		// bottom border _____
+    /* 3 rows of life, framed by a white border (corners included) */
+    gfx.DrawRect( x - m_halfSize + ( int )( ( 1 - lifeMaxLifeRatio ) * m_size ), barPosY - 1, x + m_halfSize + 1, barPosY + 2, lifebarColor );
+    gfx.DrawRectBorder( RectI( x - m_halfSize, x + m_halfSize + 1, barPosY - 2, barPosY + 3 ), 1, Colors::White );
+}
+Color Unit::getTeamColor( const Team team )
+{
+    if( Team::_A == team )
+    {
+        return Colors::Blue;
+    }
+    else if( Team::_B == team )
+    {
+        return Colors::Red;
+    }
+    return Colors::Yellow;
+}
+float Unit::getGunLength( const int unitSize )
+{
+    return GUN_LENGTH * unitSize;
+}
+RectI Unit::getDrawBounds( const bool drawExtraInfos ) const
+{
+    /* sprite, selection corners and the life bar above the sprite */
+    int extent = std::max( m_halfSize + 1, ( int )( 1.3f * m_halfSize ) + 3 );
+    if( UnitType::TANK == m_type )
+    {
+        /* gun plus the shot sprite at its end */
+        extent = std::max( extent, ( int )getGunLength( m_size ) + m_vSprites[ ( int )SpriteOrder::SHOT ].getHeight() / 2 + 3 );
+    }
+    if( drawExtraInfos )
+    {
+        extent = std::max( extent, ( int )m_attackRadius + 1 );
+    }
+    const Vei2 loc = getLocationInt();
+    RectI bounds( loc.x - extent, loc.x + extent + 1, loc.y - extent, loc.y + extent + 1 );
+
+    const auto include = [ &bounds ]( const Vei2& p, const int radius )
+    {
+        bounds.left     = std::min( bounds.left, p.x - radius );
+        bounds.right    = std::max( bounds.right, p.x + radius + 1 );
+        bounds.top      = std::min( bounds.top, p.y - radius );
+        bounds.bottom   = std::max( bounds.bottom, p.y + radius + 1 );
+    };
+    /* shots fly up to the enemy */
+    if( State::ATTACKING == m_state && m_bShotEffectActive && mp_currentEnemy )
+    {
+        const Vec2 enemy = mp_currentEnemy->getLocation();
+        include( Vei2( ( int )enemy.x, ( int )enemy.y ), m_halfSize + 4 );
+    }
+    if( drawExtraInfos && State::MOVING == m_state )
+    {
+        for( const auto& p : m_path.getWayPoints() )
+        {
+            include( Vei2( ( int )p.x, ( int )p.y ), ( int )m_path.getRadius() + 1 );
+        }
+    }
+    return bounds;
 }
 void Unit::stop()
 {
@@ -706,10 +800,10 @@ Vec2 Unit::seek( const Vec2& target, const float dt, const bool enableBreaking )
     }
 
     Vec2 steer = desired - m_velocity;
-    if( steer.GetLength() > m_maxForce )
+    if( steer.GetLength() > m_maxForce * m_forceScale )
     {
         steer.Normalize();
-        steer *= m_maxForce;
+        steer *= m_maxForce * m_forceScale;
     }
     return steer;
 }
@@ -747,10 +841,10 @@ Vec2 Unit::separateFromOtherUnits( const float dt )
         sum.Normalize();
         sum *= m_maxSpeed * dt;
         steer = sum - m_velocity;
-        if( steer.GetLength() > m_maxForce )
+        if( steer.GetLength() > m_maxForce * m_forceScale )
         {
             steer.Normalize();
-            steer *= m_maxForce;
+            steer *= m_maxForce * m_forceScale;
         }
     }
     return steer;
@@ -831,14 +925,14 @@ Vec2 Unit::getNormalPoint( const Vec2& p, const Vec2& a, const Vec2& b )
 
     return normalPoint;
 }
-void Unit::handleSelectionRect( const RectI& selectionRect, const Vei2& camOffset )
+void Unit::handleSelectionRect( const RectI& selectionRect, const Vei2& camPos )
 {
     if( m_team != Team::_A )
     {
         return;
     }
     RectI r = selectionRect.getNormalized();
-    if( r.Contains( m_location - camOffset ) )
+    if( r.Contains( m_level.worldToScreen( m_location, camPos ) ) )
     {
         m_bInsideSelectionRect = true;
     }
@@ -882,6 +976,12 @@ void Unit::takeDamage( const int damage, const UnitType EnemyType, Unit* const p
     m_bDmgEffectActive = true;
     m_dmgEffectTime = 0.0f;
 }
+void Unit::playSound( const SoundOrder sound )
+{
+#if !_DEBUG
+    m_vSoundEffects[ ( int )sound ].Play();
+#endif
+}
 void Unit::checkDestroyedEnemy( const Unit* const pDestroyedUnit )
 {
     if( mp_currentEnemy == pDestroyedUnit )
@@ -8,6 +8,13 @@
 #include "PathFinding.h"
 #include "Path.h"
 #include "Defines.h"
+#include "CombatEvents.h"
+#include "SpriteCache.h"
+
+class UnitGrid;
+class UnitActivity;
+class SimulationLod;
+class VisibilityGrid;
 
 enum class UnitType
 {
@@ -64,26 +71,43 @@ public:
           const Level& level,
           PathFinder& pPathFinder,
           std::vector< Unit* >& vpUnits,
+          CombatEventQueue& combatEvents,
           const UnitType type,
-          const std::vector< Surface >& vSprites,
+          const std::vector< SpriteAtlas::Region >& vSprites,
+          SpriteCache& spriteCache,
           std::vector< Sound >& vSoundEffects );
 
-    void draw( Graphics& gfx, const Vei2& camPos, const bool drawExtraInfos = false ) const;
-    void drawLifeBar( Graphics& gfx, const Vei2& camPos ) const;
+    /* offset: world position of the screen origin */
+    void draw( Graphics& gfx, const Vei2& offset, const bool drawExtraInfos = false ) const;
+    void drawLifeBar( Graphics& gfx, const Vei2& offset ) const;
+    /* zoom level > 0, offset: zoomed position of the screen origin (level pixels / 2^zoom). Pre-scaled sprite and gun,
+       a dot in team colour at the lowest zoom level. No selection corners, effects or extra infos */
+    void drawZoomed( Graphics& gfx, const Vei2& offset, const int zoom ) const;
+    RectI getDrawBounds( const bool drawExtraInfos = false ) const;    /* world pixels touched by draw() and drawLifeBar() */
 
-    void update( const float dt );
+    void update( const float dt, const int nFrames = 1 );      /* nFrames > 1: dt covers several frames (reduced simulation rate) */
 
-    void handleMouse( const Mouse::Event::Type& type, const Vec2& mousePos, const Vei2& camPos, const bool shift_pressed );
-    void handleSelectionRect( const RectI& selectionRect, const Vei2& camOffset );
+    bool handleMouse( const Mouse::Event::Type& type, const Vec2& mousePos, const Vei2& camPos, const bool shift_pressed );  /* returns true if a command was received */
+    void handleSelectionRect( const RectI& selectionRect, const Vei2& camPos );   /* selectionRect in screen coordinates */
     void select();
     void deselect();
-    void takeDamage( const int damage, const UnitType EnemyType, Unit* const pAttackingUnit );
+    void takeDamage( const int damage, const UnitType EnemyType, Unit* const pAttackingUnit );     /* called by CombatEventQueue::resolve() only */
+    void playSound( const SoundOrder sound );
     void checkDestroyedEnemy( const Unit* const pDestroyedUnit );   /* set mp_currentEnemy to null killed unit was current target enemy */
+    /* attacks the nearest visible enemy in attack radius (standing units only), returns true if one was found.
+       enemyInNeighbourhood is set if there is any enemy (visible or not) inside the 3x3 cell neighbourhood */
+    bool checkForEnemiesInRadius( const UnitGrid& grid, const VisibilityGrid& visibility, bool& enemyInNeighbourhood );
 
     Team getTeam() const
     {
         return m_team;
     }
+    static Color getTeamColor( const Team team );
+    static float getGunLength( const int unitSize );   /* tanks: unit center to muzzle in pixels */
+    static float getShotTravelTime()                    /* seconds from the shot to its (drawn) impact */
+    {
+        return m_shotEffectDuration;
+    }
     UnitType getType() const
     {
         return m_type;
@@ -100,6 +124,14 @@ public:
     {
         return m_bIsGroundUnit;
     }
+    bool isIdle() const             /* no order and no running effect */
+    {
+        return State::STANDING == m_state && !m_bDmgEffectActive && !m_bShotEffectActive;
+    }
+    bool isDormant() const
+    {
+        return m_bDormant;
+    }
     Vec2 getLocation() const
     {
         return m_location;
@@ -139,6 +171,18 @@ public:
     {
         return m_currWaitingTime;
     }
+    float getAttackRadius() const
+    {
+        return m_attackRadius;
+    }
+    float getVisionRadius() const
+    {
+        return m_visionRadius;
+    }
+    int getGridCellIdx() const
+    {
+        return m_gridCellIdx;
+    }
 private:    
     void stop();
 
@@ -163,11 +207,12 @@ private:
     //////////////////
     Team m_team;
     void shoot();
-    void checkForEnemiesInRadius();
     int m_attackDamage;
     std::vector< Unit* >& m_vpUnits;
+    CombatEventQueue& m_combatEvents;               /* shots are queued here and resolved after all units were updated */
     Unit* mp_currentEnemy = nullptr;
     float m_attackRadius;
+    float m_visionRadius;                           /* tiles inside this radius are visible for the own team */
     float m_timeBetweenAttacks;                     /* in milliseconds */
     std::chrono::steady_clock::time_point m_timeLastShot = std::chrono::steady_clock::now();
     /* damage animation */
@@ -194,8 +239,17 @@ private:
     void drawShotEffect( Graphics& gfx, const Vei2& offset ) const;
     float m_cannonOrientation;
     void calcSpriteDirection();                     /* which sprite to choose depending on current direction */
+    void updateCosmetics();                         /* sprite direction and cannon orientation after a phase without cosmetic updates */
     
-    const std::vector< Surface >& m_vSprites;       /* order: unit sprite -> gun shot -> death (sequence) */
+    const std::vector< SpriteAtlas::Region >& m_vSprites;  /* order: unit sprite -> gun shot -> death (sequence), atlas regions of the AssetManager */
+    const IndexedSprite* mp_sprite;                 /* unit sprite, palette indexed, shared by all units with the same sprites */
+    const Palette* mp_teamPalette;                  /* palette swaps of mp_sprite: team colour and damage flash, baked by SpriteCache */
+    const Palette* mp_dmgPalette;
+    const IndexedSprite* mp_shotSprite;
+    const GunSprites* mp_gunSprites = nullptr;      /* tanks only, baked by SpriteCache */
+    static constexpr int m_dotZoom = Level::nZoomLevels - 1;   /* zoom level at which units are drawn as dots */
+    const RleSprite* m_zoomSprites[ m_dotZoom ] = {};          /* pre-scaled team coloured sprite per zoom level, [ 0 ] unused */
+    const GunSprites* m_zoomGuns[ m_dotZoom ] = {};            /* pre-scaled mp_gunSprites per zoom level, [ 0 ] unused */
     std::vector< RectI > m_vSpriteRects;            /* rectangles for single steps (direction) of a unit sprite set */
     Direction m_spriteDirection;
     std::vector< Sound >& m_vSoundEffects;          /* order: selection -> command -> attack */
@@ -212,6 +266,16 @@ private:
 
     int m_tileIdx;
     int m_targetIdx = -1;
+    int m_gridCellIdx = -1;                         /* cell in the UnitGrid, maintained by the grid itself */
+    bool m_bDormant = false;                        /* maintained by UnitActivity */
+    int m_visionTileIdx = -1;                       /* tile of the current vision stamp, maintained by VisibilityGrid */
+
+    /* simulation level of detail, maintained by SimulationLod */
+    bool m_bFullDetail = true;                      /* false: off-screen, no cosmetic work */
+    float m_lodDt = 0.0f;                           /* accumulated time since the last reduced update */
+    int m_lodFrames = 0;                            /* number of frames accumulated in m_lodDt */
+    int m_lodCountdown = 0;                         /* frames until the next reduced update (stagger phase) */
+    float m_forceScale = 1.0f;                      /* steering force limit scales with the number of merged frames */
 
     Vec2 m_location;
     Vec2 m_acceleration;
@@ -232,4 +296,9 @@ private:
     void applyForce( const Vec2& force );
     bool isNormalPointValid( const Vec2 & start, const Vec2 & end, const Vec2& normalPoint );
     Vec2 getNormalPoint( const Vec2& p, const Vec2& a, const Vec2& b );    
+
+    friend UnitGrid;
+    friend UnitActivity;
+    friend SimulationLod;
+    friend VisibilityGrid;
 };
\ No newline at end of file
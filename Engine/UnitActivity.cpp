@@ -0,0 +1,59 @@
+#include "UnitActivity.h"
+#include "Unit.h"
+#include <algorithm>
+
+void UnitActivity::add( Unit* const pUnit )
+{
+    pUnit->m_bDormant = false;
+    m_vpActiveUnits.push_back( pUnit );
+}
+
+void UnitActivity::remove( Unit* const pUnit )
+{
+    if( pUnit->m_bDormant )
+    {
+        removeFrom( m_vpDormantUnits, pUnit );
+    }
+    else
+    {
+        removeFrom( m_vpActiveUnits, pUnit );
+    }
+}
+
+void UnitActivity::clear()
+{
+    m_vpActiveUnits.clear();
+    m_vpDormantUnits.clear();
+}
+
+void UnitActivity::wake( Unit* const pUnit )
+{
+    if( !pUnit->m_bDormant )
+    {
+        return;
+    }
+    removeFrom( m_vpDormantUnits, pUnit );
+    m_vpActiveUnits.push_back( pUnit );
+    pUnit->m_bDormant = false;
+}
+
+void UnitActivity::sleep( Unit* const pUnit )
+{
+    if( pUnit->m_bDormant )
+    {
+        return;
+    }
+    assert( pUnit->isIdle() );
+    removeFrom( m_vpActiveUnits, pUnit );
+    m_vpDormantUnits.push_back( pUnit );
+    pUnit->m_bDormant = true;
+}
+
+void UnitActivity::removeFrom( std::vector< Unit* >& vpUnits, const Unit* const pUnit )
+{
+    /* order does not matter -> swap with last and pop */
+    auto it = std::find( vpUnits.begin(), vpUnits.end(), pUnit );
+    assert( it != vpUnits.end() );
+    *it = vpUnits.back();
+    vpUnits.pop_back();
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+
+class Unit;
+
+/* splits the units into an active set (updated every frame) and a dormant set (skipped by the update loop).
+   Idle units without any enemy in their cell neighbourhood fall asleep, they are woken up again by events:
+   taking damage, receiving a command or an enemy entering their cell neighbourhood */
+class UnitActivity
+{
+public:
+    void add( Unit* const pUnit );          /* new units start active */
+    void remove( Unit* const pUnit );
+    void clear();
+
+    void wake( Unit* const pUnit );
+    void sleep( Unit* const pUnit );
+
+    const std::vector< Unit* >& getActiveUnits() const
+    {
+        return m_vpActiveUnits;
+    }
+    int getNumActive() const
+    {
+        return ( int )m_vpActiveUnits.size();
+    }
+    int getNumDormant() const
+    {
+        return ( int )m_vpDormantUnits.size();
+    }
+private:
+    static void removeFrom( std::vector< Unit* >& vpUnits, const Unit* const pUnit );
+
+    std::vector< Unit* > m_vpActiveUnits;
+    std::vector< Unit* > m_vpDormantUnits;
+};
@@ -0,0 +1,66 @@
+#include "UnitGrid.h"
+#include "Unit.h"
+
+UnitGrid::UnitGrid( const Level& level, const int cellSizeInTiles )
+{
+    assert( level.isInitialized() && cellSizeInTiles > 0 );
+
+    m_cellSize      = cellSizeInTiles * level.getTileSize();
+    m_widthInCells  = ( level.getWidth() + m_cellSize - 1 ) / m_cellSize;
+    m_heightInCells = ( level.getHeight() + m_cellSize - 1 ) / m_cellSize;
+
+    m_vCells.resize( m_widthInCells * m_heightInCells );
+}
+
+void UnitGrid::clear()
+{
+    for( auto& c : m_vCells )
+    {
+        c.clear();
+    }
+    m_vpMovedUnits.clear();
+}
+
+void UnitGrid::update( const std::vector< Unit* >& vpUnits )
+{
+    m_vpMovedUnits.clear();
+
+    for( const auto u : vpUnits )
+    {
+        const int cellIdx = getCellIdx( u->getLocation() );
+        if( cellIdx == u->m_gridCellIdx )
+        {
+            continue;
+        }
+
+        remove( u );
+        m_vCells[ cellIdx ].push_back( u );
+        u->m_gridCellIdx = cellIdx;
+        m_vpMovedUnits.push_back( u );
+    }
+}
+
+void UnitGrid::remove( Unit* const pUnit )
+{
+    if( pUnit->m_gridCellIdx < 0 )
+    {
+        return;
+    }
+
+    /* order inside a cell does not matter -> swap with last and pop */
+    std::vector< Unit* >& cell = m_vCells[ pUnit->m_gridCellIdx ];
+    auto it = std::find( cell.begin(), cell.end(), pUnit );
+    assert( it != cell.end() );
+    *it = cell.back();
+    cell.pop_back();
+
+    pUnit->m_gridCellIdx = -1;
+}
+
+int UnitGrid::getCellIdx( const Vec2& pos ) const
+{
+    const int x = std::min( std::max( ( int )pos.x / m_cellSize, 0 ), m_widthInCells - 1 );
+    const int y = std::min( std::max( ( int )pos.y / m_cellSize, 0 ), m_heightInCells - 1 );
+
+    return y * m_widthInCells + x;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "Level.h"
+
+class Unit;
+
+/* coarse spatial grid over the level, every cell holds the units currently located inside of it */
+class UnitGrid
+{
+public:
+    UnitGrid( const Level& level, const int cellSizeInTiles = 4 );
+
+    void clear();
+    void update( const std::vector< Unit* >& vpUnits );    /* moves units which crossed a cell border into their new cell */
+    void remove( Unit* const pUnit );
+
+    int getCellIdx( const Vec2& pos ) const;
+    int getCellSize() const                                 /* in pixels */
+    {
+        return m_cellSize;
+    }
+    /* units which entered a new cell during the last update() call */
+    const std::vector< Unit* >& getMovedUnits() const
+    {
+        return m_vpMovedUnits;
+    }
+
+    /* calls f( Unit* ) for every unit inside the 3x3 cell neighbourhood around cellIdx */
+    template< typename F >
+    void forEachInNeighbourhood( const int cellIdx, F f ) const
+    {
+        assert( cellIdx >= 0 && cellIdx < ( int )m_vCells.size() );
+        const int cellX = cellIdx % m_widthInCells;
+        const int cellY = cellIdx / m_widthInCells;
+
+        for( int y = std::max( cellY - 1, 0 ); y <= std::min( cellY + 1, m_heightInCells - 1 ); ++y )
+        {
+            for( int x = std::max( cellX - 1, 0 ); x <= std::min( cellX + 1, m_widthInCells - 1 ); ++x )
+            {
+                for( const auto u : m_vCells[ y * m_widthInCells + x ] )
+                {
+                    f( u );
+                }
+            }
+        }
+    }
+private:
+    int m_cellSize;
+    int m_widthInCells;
+    int m_heightInCells;
+
+    std::vector< std::vector< Unit* > > m_vCells;
+    std::vector< Unit* > m_vpMovedUnits;
+};
@@ -0,0 +1,99 @@
+#include "VisibilityGrid.h"
+#include "Unit.h"
+#include <algorithm>
+#include <cmath>
+
+VisibilityGrid::VisibilityGrid( const Level& level )
+    :
+    m_level( level )
+{
+    assert( level.isInitialized() );
+    m_widthInTiles  = level.getWidthInTiles();
+    m_heightInTiles = level.getHeightInTiles();
+
+    for( auto& c : m_vCounts )
+    {
+        c.resize( m_widthInTiles * m_heightInTiles, 0 );
+    }
+}
+
+void VisibilityGrid::clear()
+{
+    for( auto& c : m_vCounts )
+    {
+        std::fill( c.begin(), c.end(), ( unsigned short )0 );
+    }
+}
+
+void VisibilityGrid::update( const std::vector< Unit* >& vpUnits )
+{
+    for( const auto u : vpUnits )
+    {
+        const int tileIdx = u->getTileIdx();
+        if( tileIdx == u->m_visionTileIdx )
+        {
+            continue;
+        }
+
+        if( u->m_visionTileIdx >= 0 )
+        {
+            applyStamp( u, u->m_visionTileIdx, -1 );
+        }
+        applyStamp( u, tileIdx, 1 );
+        u->m_visionTileIdx = tileIdx;
+    }
+}
+
+void VisibilityGrid::remove( Unit* const pUnit )
+{
+    if( pUnit->m_visionTileIdx >= 0 )
+    {
+        applyStamp( pUnit, pUnit->m_visionTileIdx, -1 );
+        pUnit->m_visionTileIdx = -1;
+    }
+}
+
+const VisibilityGrid::Stamp& VisibilityGrid::getStamp( const int radiusInTiles )
+{
+    auto it = m_stamps.find( radiusInTiles );
+    if( it != m_stamps.end() )
+    {
+        return it->second;
+    }
+
+    Stamp stamp;
+    for( int dy = -radiusInTiles; dy <= radiusInTiles; ++dy )
+    {
+        stamp.push_back( ( int )sqrtf( ( float )( radiusInTiles * radiusInTiles - dy * dy ) ) );
+    }
+    return m_stamps.emplace( radiusInTiles, stamp ).first->second;
+}
+
+void VisibilityGrid::applyStamp( const Unit* const pUnit, const int tileIdx, const int delta )
+{
+    const int radius        = ( int )ceilf( pUnit->getVisionRadius() / m_level.getTileSize() );
+    const Stamp& stamp      = getStamp( radius );
+    std::vector< unsigned short >& counts = m_vCounts[ ( int )pUnit->getTeam() ];
+
+    const int cx = tileIdx % m_widthInTiles;
+    const int cy = tileIdx / m_widthInTiles;
+
+    /* one row operation per stamp row */
+    for( int dy = -radius; dy <= radius; ++dy )
+    {
+        const int y = cy + dy;
+        if( y < 0 || y >= m_heightInTiles )
+        {
+            continue;
+        }
+        const int halfWidth = stamp[ dy + radius ];
+        const int xStart    = std::max( cx - halfWidth, 0 );
+        const int xEnd      = std::min( cx + halfWidth, m_widthInTiles - 1 );
+
+        unsigned short* pRow = &counts[ y * m_widthInTiles ];
+        for( int x = xStart; x <= xEnd; ++x )
+        {
+            pRow[ x ] = ( unsigned short )( pRow[ x ] + delta );
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include <map>
+#include "Level.h"
+
+class Unit;
+enum class Team;
+
+/* per team visibility over the level tiles. Every unit adds its vision stamp (disc of tiles) to the counters
+   of its team, the stamp is only moved (subtract old / add new) when the unit crosses a tile border */
+class VisibilityGrid
+{
+public:
+    VisibilityGrid( const Level& level );
+
+    void clear();
+    void update( const std::vector< Unit* >& vpUnits );     /* restamps units which entered a new tile */
+    void remove( Unit* const pUnit );
+
+    bool isVisible( const Team team, const int tileIdx ) const
+    {
+        assert( tileIdx >= 0 && tileIdx < m_widthInTiles * m_heightInTiles );
+        return m_vCounts[ ( int )team ][ tileIdx ] > 0;
+    }
+    bool isVisible( const Team team, const Vec2& pos ) const
+    {
+        return isVisible( team, m_level.getTileIdx( pos ) );
+    }
+private:
+    /* half widths (in tiles) of the rows of a disc with a radius of n tiles, index = dy + n */
+    typedef std::vector< int > Stamp;
+    const Stamp& getStamp( const int radiusInTiles );
+    void applyStamp( const Unit* const pUnit, const int tileIdx, const int delta );
+
+    static constexpr int m_nTeams = 4;
+
+    const Level& m_level;
+    int m_widthInTiles;
+    int m_heightInTiles;
+
+    std::vector< unsigned short > m_vCounts[ m_nTeams ];    /* number of units seeing a tile, per team */
+    std::map< int, Stamp > m_stamps;                        /* precomputed per vision radius */
+};